@@ -4,7 +4,7 @@ DUMP_ASSEMBLY := false
 
 _CFLAGS_STD := -std=c++17
 _CFLAGS_WARNINGS := -Wall -Werror -Wextra -Wpedantic -Wunreachable-code -Wunused -Wignored-qualifiers -Wcast-align -Wformat-nonliteral -Wformat=2 -Winvalid-pch -Wmissing-declarations -Wmissing-format-attribute -Wmissing-include-dirs -Wredundant-decls -Wswitch-default -Wodr
-_CFLAGS_OTHER := -fdiagnostics-color=always
+_CFLAGS_OTHER := -fdiagnostics-color=always -ffp-contract=off
 CFLAGS := $(_CFLAGS_STD) $(_CFLAGS_WARNINGS) $(_CFLAGS_OTHER)
 
 LINK_LIBRARIES := \
@@ -14,7 +14,8 @@ BUILD_FLAGS := \
 LINK_LIBRARIES := \
 	$(LINK_LIBRARIES) \
 	stdc++fs \
-	X11
+	X11 \
+	Xrandr
 
 PRODUCTION_LINUX_ICON := sfml
 
@@ -14,7 +14,8 @@ BUILD_DEPENDENCIES :=
 
 LINK_LIBRARIES := \
 	$(LINK_LIBRARIES) \
-	X11
+	X11 \
+	Xrandr
 
 BUILD_FLAGS := \
 	-pthread
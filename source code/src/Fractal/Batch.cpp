@@ -0,0 +1,362 @@
+#include "Fractal/Batch.hpp"
+
+// the names of the fractals in the order of which_one
+
+static const char* fractal_names[] = { "mandelbrot", "julia", "burning_ship", "burning_ship_julia" };
+
+static bool parse_number(const std::string& text, double& value)
+{
+	char* end = nullptr;
+	value = std::strtod(text.c_str(), &end);
+	return !text.empty() && *end == '\0' && std::isfinite(value);
+}
+
+static bool parse_whole(const std::string& text, uint& value, uint max)
+{
+	double number;
+	if (!parse_number(text, number) || number < 0 || number > max || number != std::floor(number))
+		return false;
+	value = (uint)number;
+	return true;
+}
+
+// count numbers separated by the separator, like "-0.8,0.156" or "1920x1080"
+
+static bool parse_numbers(const std::string& text, char separator, double* values, uint count)
+{
+	std::stringstream stream(text);
+	std::string part;
+	uint i = 0;
+	while (std::getline(stream, part, separator))
+	{
+		if (i == count || !parse_number(part, values[i]))
+			return false;
+		i++;
+	}
+	return i == count;
+}
+
+// the middle of the view as two decimal numbers, kept as text until the size of the pixel tells how many bits it needs
+
+static bool parse_center(const std::string& text, std::string* center)
+{
+	size_t comma = text.find(',');
+	if (comma == std::string::npos)
+		return false;
+	center[0] = text.substr(0, comma);
+	center[1] = text.substr(comma + 1);
+
+	big_fixed check;
+	return big_from_string(center[0], 0, check) && big_from_string(center[1], 0, check);
+}
+
+// reading the options of one image (see Batch.hpp), error says what was wrong when false is returned
+
+bool parse_batch_image(const std::vector<std::string>& args, batch_image& image, std::string& error)
+{
+	frame_params& frame = image.frame;
+	frame.which_one = 0;
+	frame.width = 800;
+	frame.height = 800;
+	frame.max_iterations = 255;
+	frame.julia_param = { 0, 0 };
+	frame.progressive = false;
+	image.output.clear();
+	image.poster = false;
+
+	double view[4] = { -2, 2, 2, -2 };
+	std::string center[2];
+	double pixel = 0;
+	bool centered = false;
+
+	for (size_t i = 0; i < args.size(); i++)
+	{
+		const std::string& option = args[i];
+		if (option == "--smooth" || option == "--poster")
+		{
+			frame.colours.smooth |= option == "--smooth";
+			image.poster |= option == "--poster";
+			continue;
+		}
+		// --cache is an option of the whole batch
+		if (option == "--cache")
+		{
+			i++;
+			continue;
+		}
+		if (i + 1 == args.size())
+		{
+			error = "missing value of " + option;
+			return false;
+		}
+		const std::string& value = args[++i];
+
+		bool valid = true;
+		if (option == "--render")
+			image.output = value;
+		else if (option == "--fractal")
+		{
+			auto name = std::find(std::begin(fractal_names), std::end(fractal_names), value);
+			if (name != std::end(fractal_names))
+				frame.which_one = (uint)(name - std::begin(fractal_names));
+			else
+				valid = parse_whole(value, frame.which_one, 3);
+		}
+		else if (option == "--size")
+		{
+			double size[2] = { 0, 0 };
+			valid = parse_numbers(value, 'x', size, 2);
+			for (double side : size)
+				valid = valid && side >= 1 && side <= 1 << 20 && side == std::floor(side);
+			frame.width = (uint)size[0];
+			frame.height = (uint)size[1];
+		}
+		else if (option == "--view")
+			valid = parse_numbers(value, ',', view, 4) && view[0] < view[2] && view[3] < view[1];
+		else if (option == "--center")
+			valid = centered = parse_center(value, center);
+		else if (option == "--pixel")
+			valid = parse_number(value, pixel) && pixel > 0;
+		else if (option == "--iterations")
+			valid = parse_whole(value, frame.max_iterations, 1 << 20) && frame.max_iterations > 0;
+		else if (option == "--julia")
+		{
+			double param[2] = { 0, 0 };
+			valid = parse_numbers(value, ',', param, 2);
+			frame.julia_param = { param[0], param[1] };
+		}
+		else if (option == "--palette")
+			valid = parse_whole(value, frame.colours.palette, palette_count - 1);
+		else if (option == "--contrast")
+			valid = parse_number(value, frame.colours.contrast) && frame.colours.contrast > 0;
+		else if (option == "--band-memory")
+		{
+			uint megabytes = 0;
+			valid = parse_whole(value, megabytes, 1 << 20) && megabytes > 0;
+			image.band_memory = (size_t)megabytes << 20;
+		}
+		else
+		{
+			error = "unknown option " + option;
+			return false;
+		}
+
+		if (!valid)
+		{
+			error = "wrong value of " + option + ": " + value;
+			return false;
+		}
+	}
+
+	if (image.output.empty())
+	{
+		error = "no output file (--render image.png)";
+		return false;
+	}
+	if (centered != (pixel > 0))
+	{
+		error = "--center and --pixel go together";
+		return false;
+	}
+	// the big images don't fit into memory at once
+	if ((ullong)frame.width * frame.height > 1 << 26 || frame.width > 1 << 15 || frame.height > 1 << 15)
+		image.poster = true;
+	if (image.poster && !can_stream(image.output))
+	{
+		error = "posters are written into .png, .tif or .ppm files";
+		return false;
+	}
+	// a band is at least one row of tiles, the memory is never exceeded to make room for it
+	if (image.poster && poster_band_height(frame.width, frame.height, image.band_memory) == 0)
+	{
+		size_t needed = (poster_memory(frame.width, tile_size) + (1 << 20) - 1) >> 20;
+		error = "--band-memory is too small for one row of tiles of this width, it needs " + std::to_string(needed) + " megabytes";
+		return false;
+	}
+
+	// the view is kept the way the window keeps it, so a small enough pixel renders as a deep zoom
+	if (centered)
+	{
+		// every digit of the centre counts at a deep zoom, it is read with the precision the pixel needs
+		big_from_string(center[0], deep_precision(pixel), frame.view.center_real);
+		big_from_string(center[1], deep_precision(pixel), frame.view.center_imag);
+		frame.view.pixel = { pixel, pixel };
+		view_corners(frame.view, frame.width, frame.height, frame.top_left, frame.bottom_right);
+	}
+	else
+	{
+		frame.top_left = { view[0], view[1] };
+		frame.bottom_right = { view[2], view[3] };
+		frame.view.center_real = big_from_double((view[0] + view[2]) / 2, 2);
+		frame.view.center_imag = big_from_double((view[1] + view[3]) / 2, 2);
+		frame.view.pixel = { (view[2] - view[0]) / frame.width, (view[1] - view[3]) / frame.height };
+	}
+	frame.deep = frame.which_one == 0 && needs_deep_zoom(frame.view);
+	return true;
+}
+
+// rendering one frame with the thread pool and waiting for it, rgba gets its pixels row after row
+
+bool render_image(util::ThreadPool& pool, const frame_params& frame, tile_cache* cache, std::vector<sf::Uint8>& rgba)
+{
+	framebuffer target;
+	target.cache = cache;
+	target.resize(frame.width, frame.height);
+
+	std::shared_ptr<render_job> job = which(pool, target, frame);
+	target.wait_idle();
+	if (job->cancelled())
+		return false;
+
+	rgba.resize((size_t)frame.width * frame.height * 4);
+	read_rows(target, 0, frame.height, rgba.data());
+	return true;
+}
+
+// binary ppm, the alpha of the pixels is left out
+
+bool write_ppm(const std::string& path, uint width, uint height, const sf::Uint8* rgba)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file << "P6\n"
+		 << width << ' ' << height << "\n255\n";
+
+	std::vector<char> row(3 * width);
+	for (uint y = 0; y < height && file; y++)
+	{
+		for (uint x = 0; x < width; x++)
+		{
+			const sf::Uint8* pixel = rgba + 4 * ((size_t)y * width + x);
+			row[3 * x] = pixel[0];
+			row[3 * x + 1] = pixel[1];
+			row[3 * x + 2] = pixel[2];
+		}
+		file.write(row.data(), row.size());
+	}
+	return (bool)file;
+}
+
+static bool has_extension(const std::string& path, const std::string& extension)
+{
+	std::string end = path.size() >= extension.size() ? path.substr(path.size() - extension.size()) : "";
+	std::transform(end.begin(), end.end(), end.begin(), ::tolower);
+	return end == extension;
+}
+
+// sf::Image only keeps the pixels in memory, saving it needs no window
+
+bool save_image_file(const std::string& path, uint width, uint height, const std::vector<sf::Uint8>& rgba)
+{
+	if (has_extension(path, ".ppm"))
+		return write_ppm(path, width, height, rgba.data());
+
+	sf::Image image;
+	image.create(width, height, rgba.data());
+	return image.saveToFile(path);
+}
+
+static void print_usage()
+{
+	std::cout << "Usage:\n"
+			  << "  explorer --render image.png [--fractal mandelbrot|julia|burning_ship|burning_ship_julia] [--size 1920x1080]\n"
+			  << "           [--view left,top,right,bottom | --center real,imag --pixel size] [--iterations 1000]\n"
+			  << "           [--julia real,imag] [--palette 0-2] [--smooth] [--contrast 1.5] [--cache directory]\n"
+			  << "           [--poster] [--band-memory megabytes]\n"
+			  << "  explorer --batch jobs.txt [--cache directory]   (the options of one image on every line)\n"
+			  << "  explorer --benchmark results.json|- [--quick] [--sizes 256,512] [--iterations 256,2048] [--threads 1,2,4] [--repeats 3]"
+			  << std::endl;
+}
+
+// the entry point of the program when it is started with options, returns the exit code
+
+int batch_main(int argc, char** argv)
+{
+	std::vector<std::string> args(argv + 1, argv + argc);
+	std::string batch_file;
+	std::string cache_directory;
+	for (size_t i = 0; i < args.size(); i++)
+	{
+		if (args[i] == "--help" || args[i] == "-h")
+		{
+			print_usage();
+			return 0;
+		}
+		if (args[i] == "--benchmark")
+			return benchmark_main(args);
+		if (args[i] == "--batch" && i + 1 < args.size())
+			batch_file = args[i + 1];
+		if (args[i] == "--cache" && i + 1 < args.size())
+			cache_directory = args[i + 1];
+	}
+
+	// every image is a line of options, the comments and the empty lines are skipped
+	std::vector<std::vector<std::string>> images;
+	std::vector<uint> lines;
+	if (batch_file.empty())
+		images.push_back(args);
+	else
+	{
+		std::ifstream file(batch_file);
+		if (!file)
+		{
+			std::cerr << "Can't read " << batch_file << std::endl;
+			return 1;
+		}
+		std::string line;
+		for (uint number = 1; std::getline(file, line); number++)
+		{
+			std::stringstream stream(line);
+			std::vector<std::string> options;
+			std::string option;
+			while (stream >> option)
+				options.push_back(option);
+			if (!options.empty() && options[0][0] != '#')
+			{
+				images.push_back(options);
+				lines.push_back(number);
+			}
+		}
+	}
+
+	std::unique_ptr<tile_cache> cache;
+	if (!cache_directory.empty())
+	{
+		cache = std::make_unique<tile_cache>();
+		cache->set_directory(cache_directory);
+	}
+
+	int failed = 0;
+	std::vector<sf::Uint8> rgba;
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		batch_image image;
+		std::string error;
+		if (!parse_batch_image(images[i], image, error))
+		{
+			std::cerr << (batch_file.empty() ? "" : batch_file + ":" + std::to_string(lines[i]) + ": ") << error << std::endl;
+			if (batch_file.empty())
+				print_usage();
+			failed++;
+			continue;
+		}
+
+		sf::Clock clock;
+		bool rendered;
+		if (image.poster)
+		{
+			std::unique_ptr<image_writer> writer = open_image_writer(image.output, image.frame.width, image.frame.height);
+			rendered = writer && render_poster(render_pool(), image.frame, cache.get(), *writer, image.band_memory);
+		}
+		else
+			rendered = render_image(render_pool(), image.frame, cache.get(), rgba) && save_image_file(image.output, image.frame.width, image.frame.height, rgba);
+		if (!rendered)
+		{
+			std::cerr << "Can't render " << image.output << std::endl;
+			failed++;
+			continue;
+		}
+		std::cout << image.output << ": " << fractal_names[image.frame.which_one] << ' ' << image.frame.width << 'x'
+				  << image.frame.height << " in " << clock.getElapsedTime().asSeconds() << " s" << std::endl;
+	}
+	return failed == 0 ? 0 : 1;
+}
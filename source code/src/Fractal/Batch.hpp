@@ -0,0 +1,45 @@
+#ifndef FRACTAL_BATCH_HPP
+#define FRACTAL_BATCH_HPP
+
+#include "Fractal/Benchmark.hpp"
+#include "Fractal/Poster.hpp"
+
+//
+//  rendering images from the command line, without a window (or any GL context)
+// the frames go through the same which() and generate() as the window, only the pixels are saved into a file
+//
+//  explorer --render image.png [options]      one image
+//  explorer --batch jobs.txt [--cache dir]     every line of the file has the options of one image (--render included)
+//  explorer --benchmark results.json [...]    measures the kernels instead of rendering (see Benchmark.hpp)
+//
+// options:
+//  --fractal mandelbrot|julia|burning_ship|burning_ship_julia (or 0 - 3)
+//  --size 1920x1080
+//  --view left,top,right,bottom         the corners of the image, -2,2,2,-2 by default
+//  --center real,imag --pixel size      the middle of the image and the size of one pixel instead of --view,
+//                                       the middle is read with all of its digits for the deep zooms
+//  --iterations 1000
+//  --julia real,imag                    the julia parameter
+//  --palette 0-2 --smooth --contrast 1.5
+//  --cache dir                          keep the tiles on the disk in dir (see TileCache.hpp)
+//  --poster [--band-memory 512]         render in bands straight into the file (.png, .tif or .ppm, see Poster.hpp)
+//                                       with at most that many megabytes in memory, images of more than
+//                                       64 megapixels are always rendered like that, the sides can be up to 1048576
+//                                       (a band is at least 64 rows, a wider image may need more than 512)
+//
+
+struct batch_image
+{
+	frame_params frame;
+	std::string output; // .ppm is written directly, the other extensions (.png, .bmp ...) by sf::Image
+	bool poster = false;
+	size_t band_memory = 512 << 20;
+};
+
+bool parse_batch_image(const std::vector<std::string>& args, batch_image& image, std::string& error);
+bool render_image(util::ThreadPool& pool, const frame_params& frame, tile_cache* cache, std::vector<sf::Uint8>& rgba);
+bool write_ppm(const std::string& path, uint width, uint height, const sf::Uint8* rgba);
+bool save_image_file(const std::string& path, uint width, uint height, const std::vector<sf::Uint8>& rgba);
+int batch_main(int argc, char** argv);
+
+#endif // FRACTAL_BATCH_HPP
@@ -0,0 +1,341 @@
+#include "Fractal/Benchmark.hpp"
+
+#include <chrono>
+
+// the views every version is measured on, the same ones every time so the results can be compared
+
+const std::vector<benchmark_view> benchmark_views = {
+	{ "full_set", 0, { -0.75, 0 }, 3, { 0, 0 } },
+	{ "seahorse_valley", 0, { -0.7436, 0.1318 }, 0.01, { 0, 0 } },
+	{ "deep_interior", 0, { -0.1225, 0.7449 }, 0.05, { 0, 0 } }, // inside the period 3 bulb, found by the cycle check
+	{ "julia_full_set", 1, { 0, 0 }, 3, { -0.8, 0.156 } },
+	{ "burning_ship_antenna", 2, { -1.765, -0.03 }, 0.1, { 0, 0 } },
+	{ "burning_ship_julia_full_set", 3, { 0, 0 }, 4, { -1.755, -0.03 } }
+};
+
+static const char* scalar_kernel_names[] = { "mendel_iter", "mandelbrot_julia_iter", "burning_ship_iter", "burning_ship_julia_iter" };
+static row_kernel row_kernels::*const kernel_members[] = { &row_kernels::mandelbrot, &row_kernels::mandelbrot_julia,
+	&row_kernels::burning_ship, &row_kernels::burning_ship_julia };
+
+static uint scalar_iter(uint which_one, complex pos, uint max_iterations, complex point)
+{
+	switch (which_one)
+	{
+		case 1:
+			return mandelbrot_julia_iter(pos, max_iterations, point);
+		case 2:
+			return burning_ship_iter(pos, max_iterations);
+		case 3:
+			return burning_ship_julia_iter(pos, max_iterations, point);
+		default:
+			return mendel_iter(pos, max_iterations);
+	}
+}
+
+static frame_params view_frame(const benchmark_view& view, uint size, uint max_iterations)
+{
+	frame_params frame;
+	frame.which_one = view.which_one;
+	frame.width = size;
+	frame.height = size;
+	frame.top_left = { view.center.real - view.side / 2, view.center.imag + view.side / 2 };
+	frame.bottom_right = { view.center.real + view.side / 2, view.center.imag - view.side / 2 };
+	frame.max_iterations = max_iterations;
+	frame.julia_param = view.julia_param;
+	frame.view.center_real = big_from_double(view.center.real, 2);
+	frame.view.center_imag = big_from_double(view.center.imag, 2);
+	frame.view.pixel = { view.side / size, view.side / size };
+	return frame;
+}
+
+// body(row) for every row, the rows are split between the workers of the pool only
+// (parallelFor would let the calling thread help and the pool of 1 thread would run 2 of them)
+
+// the calling thread sleeps until the last row wakes it, spinning would take a processor from the workers
+
+static void spread_rows(util::ThreadPool& pool, uint count, const std::function<void(uint)>& body)
+{
+	uint remaining = count;
+	std::mutex done_mutex;
+	std::condition_variable done;
+	for (uint y = 0; y < count; y++)
+	{
+		pool.submit([&, y]() {
+			body(y);
+			std::lock_guard<std::mutex> lock(done_mutex);
+			if (--remaining == 0)
+				done.notify_all();
+		});
+	}
+
+	std::unique_lock<std::mutex> lock(done_mutex);
+	done.wait(lock, [&]() {
+		return remaining == 0;
+	});
+}
+
+// one run of one way of computing the frame, the iterations of all its pixels are added up into iterations
+
+static double time_run(util::ThreadPool& pool, const std::string& kernel, const frame_params& frame, ullong& iterations)
+{
+	const pixel_grid grid = frame_grid(frame);
+	std::vector<uint> counts((size_t)frame.width * frame.height);
+	std::unique_ptr<framebuffer> target;
+	if (kernel == "generate")
+	{
+		// resized before the clock starts, a new framebuffer has no complete frame to take the pixels over from
+		target = std::make_unique<framebuffer>();
+		target->resize(frame.width, frame.height);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	if (kernel == "generate")
+	{
+		which(pool, *target, frame);
+		target->wait_idle();
+	}
+	else if (kernel == "row_kernel")
+	{
+		const row_kernel row_function = best_row_kernels().*kernel_members[frame.which_one];
+		spread_rows(pool, frame.height, [&](uint y) {
+			row_job row;
+			row.origin_real = grid.center.real;
+			row.step = grid.delta.real;
+			row.imag = grid.center.imag - (y + grid.y_offset) * grid.delta.imag;
+			row.x_begin = grid.x_offset;
+			row.count = frame.width;
+			row.max_iterations = frame.max_iterations;
+			row.point = frame.julia_param;
+			row.reference = nullptr;
+			row.reference_length = 0;
+			row_function(row, &counts[(size_t)y * frame.width]);
+		});
+	}
+	else
+	{
+		spread_rows(pool, frame.height, [&](uint y) {
+			complex pos;
+			pos.imag = grid.center.imag - (y + grid.y_offset) * grid.delta.imag;
+			for (uint x = 0; x < frame.width; x++)
+			{
+				pos.real = grid.center.real + (x + grid.x_offset) * grid.delta.real;
+				counts[(size_t)y * frame.width + x] = scalar_iter(frame.which_one, pos, frame.max_iterations, frame.julia_param);
+			}
+		});
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	const std::vector<uint>& result = target ? target->iterations : counts;
+	iterations = 0;
+	for (uint count : result)
+		iterations += count;
+	return seconds;
+}
+
+static std::vector<uint> default_thread_counts()
+{
+	const uint hardware = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<uint> counts;
+	for (uint threads = 1; threads < hardware; threads *= 2)
+		counts.push_back(threads);
+	counts.push_back(hardware);
+	return counts;
+}
+
+std::vector<benchmark_result> run_benchmarks(const benchmark_options& options, std::ostream* progress)
+{
+	std::vector<benchmark_result> results;
+	const std::vector<uint> thread_counts = options.thread_counts.empty() ? default_thread_counts() : options.thread_counts;
+
+	for (uint threads : thread_counts)
+	{
+		util::ThreadPool pool(threads);
+		for (const benchmark_view& view : benchmark_views)
+		{
+			const std::string kernels[] = { scalar_kernel_names[view.which_one], "row_kernel", "generate" };
+			for (uint size : options.sizes)
+			{
+				for (uint max_iterations : options.iteration_caps)
+				{
+					const frame_params frame = view_frame(view, size, max_iterations);
+					for (const std::string& kernel : kernels)
+					{
+						benchmark_result result;
+						result.view = view.name;
+						result.kernel = kernel;
+						result.size = size;
+						result.max_iterations = max_iterations;
+						result.threads = threads;
+						result.pixels = (ullong)size * size;
+						result.seconds = INFINITY;
+						for (uint i = 0; i < std::max(1u, options.repeats); i++)
+							result.seconds = std::min(result.seconds, time_run(pool, kernel, frame, result.iterations));
+						results.push_back(result);
+
+						if (progress)
+							*progress << view.name << ' ' << kernel << ' ' << size << 'x' << size << ' ' << max_iterations
+									  << " iterations, " << threads << " threads: " << result.pixels / result.seconds / 1e6
+									  << " Mpixels/s" << std::endl;
+					}
+				}
+			}
+		}
+	}
+
+	// the same run with the smallest number of threads is the base of the speedup
+	for (benchmark_result& result : results)
+	{
+		for (const benchmark_result& base : results)
+		{
+			if (base.threads == thread_counts.front() && base.view == result.view && base.kernel == result.kernel
+				&& base.size == result.size && base.max_iterations == result.max_iterations)
+				result.speedup = base.seconds / result.seconds;
+		}
+	}
+	return results;
+}
+
+static void write_list(std::ostream& out, const std::vector<uint>& values)
+{
+	out << '[';
+	for (size_t i = 0; i < values.size(); i++)
+		out << (i ? ", " : "") << values[i];
+	out << ']';
+}
+
+void write_benchmark_json(std::ostream& out, const benchmark_options& options, const std::vector<benchmark_result>& results)
+{
+	out << std::setprecision(9);
+	out << "{\n"
+		<< "  \"simd\": \"" << simd_level_name(best_row_kernels().level) << "\",\n"
+		<< "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+		<< "  \"repeats\": " << options.repeats << ",\n"
+		<< "  \"sizes\": ";
+	write_list(out, options.sizes);
+	out << ",\n  \"iteration_caps\": ";
+	write_list(out, options.iteration_caps);
+	out << ",\n  \"results\": [";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const benchmark_result& result = results[i];
+		// a run too short for the clock still gets finite rates
+		const double seconds = std::max(result.seconds, 1e-9);
+		out << (i ? "," : "") << "\n    { "
+			<< "\"view\": \"" << result.view << "\", "
+			<< "\"kernel\": \"" << result.kernel << "\", "
+			<< "\"size\": " << result.size << ", "
+			<< "\"max_iterations\": " << result.max_iterations << ", "
+			<< "\"threads\": " << result.threads << ", "
+			<< "\"seconds\": " << result.seconds << ", "
+			<< "\"pixels\": " << result.pixels << ", "
+			<< "\"iterations\": " << result.iterations << ", "
+			<< "\"mpixels_per_second\": " << result.pixels / seconds / 1e6 << ", "
+			<< "\"iterations_per_second\": " << result.iterations / seconds << ", "
+			<< "\"speedup\": " << result.speedup << " }";
+	}
+	out << "\n  ]\n}\n";
+}
+
+// "256,512" into { 256, 512 }, every number has to be between 1 and max
+
+static bool parse_list(const std::string& text, std::vector<uint>& values, uint max)
+{
+	std::stringstream stream(text);
+	std::string part;
+	values.clear();
+	while (std::getline(stream, part, ','))
+	{
+		char* end = nullptr;
+		unsigned long value = std::strtoul(part.c_str(), &end, 10);
+		if (part.empty() || *end != '\0' || part[0] == '-' || value < 1 || value > max)
+			return false;
+		values.push_back((uint)value);
+	}
+	return !values.empty();
+}
+
+bool parse_benchmark_options(const std::vector<std::string>& args, benchmark_options& options, std::string& output, std::string& error)
+{
+	output.clear();
+	for (size_t i = 0; i < args.size(); i++)
+	{
+		const std::string& option = args[i];
+		if (option == "--quick")
+		{
+			options.sizes = { 128 };
+			options.iteration_caps = { 256 };
+			options.repeats = 1;
+			continue;
+		}
+		if (i + 1 == args.size())
+		{
+			error = "missing value of " + option;
+			return false;
+		}
+		const std::string& value = args[++i];
+
+		bool valid = true;
+		if (option == "--benchmark")
+			output = value;
+		else if (option == "--sizes")
+			valid = parse_list(value, options.sizes, 1 << 14);
+		else if (option == "--iterations")
+			valid = parse_list(value, options.iteration_caps, 1 << 20);
+		else if (option == "--threads")
+			valid = parse_list(value, options.thread_counts, 1024);
+		else if (option == "--repeats")
+		{
+			std::vector<uint> repeats;
+			valid = parse_list(value, repeats, 100) && repeats.size() == 1;
+			options.repeats = valid ? repeats[0] : options.repeats;
+		}
+		else
+		{
+			error = "unknown option " + option;
+			return false;
+		}
+
+		if (!valid)
+		{
+			error = "wrong value of " + option + ": " + value;
+			return false;
+		}
+	}
+	if (output.empty())
+	{
+		error = "no output file (--benchmark results.json, - for the standard output)";
+		return false;
+	}
+	return true;
+}
+
+// the entry point of explorer --benchmark, returns the exit code
+
+int benchmark_main(const std::vector<std::string>& args)
+{
+	benchmark_options options;
+	std::string output;
+	std::string error;
+	if (!parse_benchmark_options(args, options, output, error))
+	{
+		std::cerr << error << std::endl;
+		return 1;
+	}
+
+	// the progress goes to the error output so the json can go to the standard one
+	std::vector<benchmark_result> results = run_benchmarks(options, &std::cerr);
+	if (output == "-")
+	{
+		write_benchmark_json(std::cout, options, results);
+		return 0;
+	}
+	std::ofstream file(output, std::ios::trunc);
+	write_benchmark_json(file, options, results);
+	if (!file)
+	{
+		std::cerr << "Can't write " << output << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef FRACTAL_BENCHMARK_HPP
+#define FRACTAL_BENCHMARK_HPP
+
+#include "Fractal/Kernels.hpp"
+#include "Fractal/Render.hpp"
+
+//
+//  measuring how fast the fractals are computed, so a slower version can be told apart from a faster one
+// every reference view is computed three ways at every size, iteration cap and number of threads:
+//  the scalar escape time function of its fractal (mendel_iter ...) for every pixel, the rows split between the threads
+//  the best row kernel of the machine (see SimdKernels.hpp) for every row, split the same way
+//  generate() through which(), the way the window renders a frame (tiles, symmetry, subdivision ...)
+// the fastest of a few repeats is kept, the results are written as json
+//
+//  explorer --benchmark results.json [--quick] [--sizes 256,512] [--iterations 256,2048] [--threads 1,2,4] [--repeats 3]
+//
+// the file "-" is the standard output, the iterations are the ones the pixels end with (the pixels of the
+// interior count max_iterations even when a shortcut found them), speedup is against the smallest number of threads
+//
+
+// a fixed part of one of the fractals, the views are squares
+
+struct benchmark_view
+{
+	const char* name;
+	uint which_one;
+	complex center;
+	double side;
+	complex julia_param;
+};
+
+extern const std::vector<benchmark_view> benchmark_views;
+
+struct benchmark_options
+{
+	std::vector<uint> sizes { 256, 512 };
+	std::vector<uint> iteration_caps { 256, 2048 };
+	std::vector<uint> thread_counts; // 1, 2, 4 ... up to the hardware when empty
+	uint repeats = 3;
+};
+
+struct benchmark_result
+{
+	std::string view;
+	std::string kernel; // mendel_iter ..., row_kernel or generate
+	uint size;
+	uint max_iterations;
+	uint threads;
+	double seconds;
+	ullong pixels;
+	ullong iterations;
+	double speedup = 1;
+};
+
+bool parse_benchmark_options(const std::vector<std::string>& args, benchmark_options& options, std::string& output, std::string& error);
+std::vector<benchmark_result> run_benchmarks(const benchmark_options& options, std::ostream* progress = nullptr);
+void write_benchmark_json(std::ostream& out, const benchmark_options& options, const std::vector<benchmark_result>& results);
+int benchmark_main(const std::vector<std::string>& args);
+
+#endif // FRACTAL_BENCHMARK_HPP
@@ -0,0 +1,260 @@
+#include "Fractal/BigFixed.hpp"
+
+// limb i of a, numbers with less limbs are padded with zeros
+
+static uint limb(const big_fixed& a, size_t i)
+{
+	return i < a.limbs.size() ? a.limbs[i] : 0;
+}
+
+static void fix_zero_sign(big_fixed& a)
+{
+	for (uint l : a.limbs)
+	{
+		if (l != 0)
+			return;
+	}
+	a.negative = false;
+}
+
+// -1, 0 or 1 depending on whether |a| is smaller, equal or bigger than |b|
+
+static int compare_magnitude(const big_fixed& a, const big_fixed& b)
+{
+	size_t n = std::max(a.limbs.size(), b.limbs.size());
+	for (size_t i = 0; i < n; i++)
+	{
+		uint x = limb(a, i);
+		uint y = limb(b, i);
+		if (x != y)
+			return x < y ? -1 : 1;
+	}
+	return 0;
+}
+
+// |a| + |b|
+
+static big_fixed add_magnitude(const big_fixed& a, const big_fixed& b)
+{
+	size_t n = std::max(a.limbs.size(), b.limbs.size());
+	big_fixed r;
+	r.limbs.assign(n, 0);
+
+	ullong carry = 0;
+	for (size_t i = n; i-- > 0;)
+	{
+		ullong sum = (ullong)limb(a, i) + limb(b, i) + carry;
+		r.limbs[i] = (uint)sum;
+		carry = sum >> 32;
+	}
+	return r;
+}
+
+// |a| - |b|, |a| has to be at least |b|
+
+static big_fixed sub_magnitude(const big_fixed& a, const big_fixed& b)
+{
+	size_t n = std::max(a.limbs.size(), b.limbs.size());
+	big_fixed r;
+	r.limbs.assign(n, 0);
+
+	llong borrow = 0;
+	for (size_t i = n; i-- > 0;)
+	{
+		llong difference = (llong)limb(a, i) - limb(b, i) - borrow;
+		borrow = difference < 0;
+		if (difference < 0)
+			difference += 1LL << 32;
+		r.limbs[i] = (uint)difference;
+	}
+	return r;
+}
+
+// converting a double into a number with fraction_limbs limbs after the point, this is exact
+
+big_fixed big_from_double(double value, uint fraction_limbs)
+{
+	big_fixed r;
+	r.negative = value < 0;
+	r.limbs.assign(fraction_limbs + 1, 0);
+
+	double v = std::abs(value);
+	double whole = std::floor(v);
+	r.limbs[0] = (uint)whole;
+	v -= whole;
+
+	for (uint i = 1; i <= fraction_limbs; i++)
+	{
+		v *= 4294967296.0;
+		double part = std::floor(v);
+		r.limbs[i] = (uint)part;
+		v -= part;
+	}
+
+	fix_zero_sign(r);
+	return r;
+}
+
+// reading a decimal number (like -0.75, 1.5e-30) with fraction_limbs limbs after the point, false when it isn't one
+// unlike a double it keeps every digit of the text, the bits past the last limb are cut off like big_from_double() does
+
+bool big_from_string(const std::string& text, uint fraction_limbs, big_fixed& a)
+{
+	size_t i = 0;
+	bool negative = false;
+	if (i < text.size() && (text[i] == '-' || text[i] == '+'))
+		negative = text[i++] == '-';
+
+	// the digits without the point, point is the number of the whole ones
+	std::vector<uint8_t> digits;
+	llong point = -1;
+	for (; i < text.size(); i++)
+	{
+		if (text[i] >= '0' && text[i] <= '9')
+			digits.push_back(text[i] - '0');
+		else if (text[i] == '.' && point < 0)
+			point = digits.size();
+		else
+			break;
+	}
+	if (digits.empty())
+		return false;
+	if (point < 0)
+		point = digits.size();
+
+	// the exponent only moves the point
+	if (i < text.size() && (text[i] == 'e' || text[i] == 'E'))
+	{
+		size_t first = i + 1 + (i + 1 < text.size() && (text[i + 1] == '-' || text[i + 1] == '+'));
+		if (first == text.size() || text[first] < '0' || text[first] > '9')
+			return false;
+		char* end = nullptr;
+		long shift = std::strtol(text.c_str() + i + 1, &end, 10);
+		if (std::abs(shift) > 100000)
+			return false;
+		point += shift;
+		i = end - text.c_str();
+	}
+	if (i != text.size())
+		return false;
+
+	// the whole part has to fit into the first limb
+	ullong whole = 0;
+	for (llong d = 0; d < point; d++)
+	{
+		whole = whole * 10 + (d < (llong)digits.size() ? digits[d] : 0);
+		if (whole > 0xffffffffULL)
+			return false;
+	}
+
+	// the digits after the point, with the zeros a negative point puts in front of them
+	std::vector<uint8_t> fraction(point < 0 ? -point : 0, 0);
+	if (point < (llong)digits.size())
+		fraction.insert(fraction.end(), digits.begin() + std::max<llong>(point, 0), digits.end());
+
+	a.negative = negative;
+	a.limbs.assign(fraction_limbs + 1, 0);
+	a.limbs[0] = (uint)whole;
+	for (uint limb = 1; limb <= fraction_limbs; limb++)
+	{
+		// multiplying the fraction by 2^32, what gets past the point is the next limb
+		ullong carry = 0;
+		for (size_t d = fraction.size(); d-- > 0;)
+		{
+			ullong value = fraction[d] * 4294967296ULL + carry;
+			fraction[d] = value % 10;
+			carry = value / 10;
+		}
+		a.limbs[limb] = (uint)carry;
+	}
+
+	fix_zero_sign(a);
+	return true;
+}
+
+// the closest double, adding the limbs up from the least significant one
+
+double big_to_double(const big_fixed& a)
+{
+	double r = 0;
+	for (size_t i = a.limbs.size(); i-- > 0;)
+		r = r / 4294967296.0 + a.limbs[i];
+
+	return a.negative ? -r : r;
+}
+
+big_fixed big_add(const big_fixed& a, const big_fixed& b)
+{
+	big_fixed r;
+	if (a.negative == b.negative)
+	{
+		r = add_magnitude(a, b);
+		r.negative = a.negative;
+	}
+	else if (compare_magnitude(a, b) >= 0)
+	{
+		r = sub_magnitude(a, b);
+		r.negative = a.negative;
+	}
+	else
+	{
+		r = sub_magnitude(b, a);
+		r.negative = b.negative;
+	}
+
+	fix_zero_sign(r);
+	return r;
+}
+
+big_fixed big_sub(const big_fixed& a, const big_fixed& b)
+{
+	big_fixed minus_b = b;
+	minus_b.negative = !b.negative;
+	return big_add(a, minus_b);
+}
+
+// schoolbook multiplication, the result keeps as many limbs after the point as the more precise operand
+// (the rest is cut off)
+
+big_fixed big_mul(const big_fixed& a, const big_fixed& b)
+{
+	size_t na = a.limbs.size();
+	size_t nb = b.limbs.size();
+
+	// the full product, least significant limb first
+	std::vector<uint> product(na + nb, 0);
+	for (size_t i = 0; i < na; i++)
+	{
+		ullong x = a.limbs[na - 1 - i];
+		ullong carry = 0;
+		for (size_t j = 0; j < nb; j++)
+		{
+			ullong t = x * b.limbs[nb - 1 - j] + product[i + j] + carry;
+			product[i + j] = (uint)t;
+			carry = t >> 32;
+		}
+		product[i + nb] = (uint)carry;
+	}
+
+	// product[(na - 1) + (nb - 1)] is the whole part
+	size_t fraction = std::max(na, nb) - 1;
+	big_fixed r;
+	r.limbs.assign(fraction + 1, 0);
+	for (size_t f = 0; f <= fraction; f++)
+		r.limbs[f] = product[(na - 1) + (nb - 1) - f];
+
+	r.negative = a.negative != b.negative;
+	fix_zero_sign(r);
+	return r;
+}
+
+void big_set_precision(big_fixed& a, uint fraction_limbs)
+{
+	a.limbs.resize(fraction_limbs + 1, 0);
+	fix_zero_sign(a);
+}
+
+uint big_precision(const big_fixed& a)
+{
+	return (uint)a.limbs.size() - 1;
+}
@@ -0,0 +1,23 @@
+#ifndef FRACTAL_BIG_FIXED_HPP
+#define FRACTAL_BIG_FIXED_HPP
+
+// signed fixed point number with as many bits after the point as needed
+// limbs[0] is the whole part, limbs[i] is worth 2^(-32 i)
+// used for the few numbers that need more precision than double at deep zoom (centre of the view, reference orbit)
+
+struct big_fixed
+{
+	bool negative = false;
+	std::vector<uint> limbs = std::vector<uint>(1, 0);
+};
+
+big_fixed big_from_double(double value, uint fraction_limbs);
+bool big_from_string(const std::string& text, uint fraction_limbs, big_fixed& a);
+double big_to_double(const big_fixed& a);
+big_fixed big_add(const big_fixed& a, const big_fixed& b);
+big_fixed big_sub(const big_fixed& a, const big_fixed& b);
+big_fixed big_mul(const big_fixed& a, const big_fixed& b);
+void big_set_precision(big_fixed& a, uint fraction_limbs);
+uint big_precision(const big_fixed& a);
+
+#endif // FRACTAL_BIG_FIXED_HPP
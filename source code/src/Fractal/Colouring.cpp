@@ -0,0 +1,226 @@
+#include "Fractal/Colouring.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define FRACTAL_SIMD_X86
+	#include <immintrin.h>
+#endif
+
+// the number of iterations with a fraction, so the colours change smoothly instead of in bands
+// n + 1 - log2(ln |z|) grows by exactly 1 when the pixel needs one more iteration to escape
+// the pixels without a last z (inside the set or filled in by subdivision) keep their whole number
+
+double smooth_iterations(uint iterations, complex last_z, uint max_iterations)
+{
+	if (iterations >= max_iterations || !std::isfinite(last_z.real) || !std::isfinite(last_z.imag))
+		return iterations;
+
+	double square = last_z.real * last_z.real + last_z.imag * last_z.imag;
+	// the pixels that start outside the escape radius have nothing to smooth
+	if (square <= 1)
+		return iterations;
+
+	return std::max(0., iterations + 1 - std::log2(0.5 * std::log(square)));
+}
+
+// channel of the fire palette, t goes once around the palette from 0 to 1
+
+static sf::Uint8 wave(double t, double phase)
+{
+	return (sf::Uint8)(127.5 * (1 - std::cos(2 * M_PI * (t + phase))));
+}
+
+// function to change the number of iterations to a color of the pixel
+// interior is set for the pixels that reached max_iterations
+
+sf::Color colour_palette(double iterations, bool interior, const colouring& colours)
+{
+	sf::Color pixel;
+	pixel.a = 255; // alpha / opacity of this pixel
+
+	double value = iterations * colours.contrast + colours.offset;
+
+	switch (colours.palette)
+	{
+		case 1: // fire
+		{
+			if (interior)
+				return sf::Color::Black;
+			double t = value / 64 - std::floor(value / 64);
+			pixel.r = wave(t, 0);
+			pixel.g = wave(t, -0.15);
+			pixel.b = wave(t, -0.3);
+			break;
+		}
+		case 2: // grey
+		{
+			if (interior)
+				return sf::Color::Black;
+			double t = value / 128 - std::floor(value / 128);
+			pixel.r = pixel.g = pixel.b = (sf::Uint8)(510 * std::min(t, 1 - t));
+			break;
+		}
+		default: // simple colour palette
+		{
+			uint8_t colour = (uint8_t)(llong)std::floor(value);
+			pixel.r = colour;	  // red
+			pixel.g = 2 * colour; // green
+			pixel.b = 3 * colour; // blue
+			break;
+		}
+	}
+
+	return pixel;
+}
+
+static uint32_t pack(sf::Color colour)
+{
+	const sf::Uint8 bytes[4] = { colour.r, colour.g, colour.b, colour.a };
+	uint32_t packed;
+	std::memcpy(&packed, bytes, 4);
+	return packed;
+}
+
+// the palette is evaluated once per number of iterations instead of once per pixel
+
+palette_lut build_palette(const colouring& colours, uint max_iterations)
+{
+	palette_lut palette;
+	build_palette(colours, max_iterations, palette);
+	return palette;
+}
+
+// the same into an existing table, its vector keeps its memory when the new one isn't longer
+
+void build_palette(const colouring& colours, uint max_iterations, palette_lut& palette)
+{
+	palette.max_iterations = max_iterations;
+	palette.smooth = colours.smooth;
+	palette.interior = pack(colour_palette(max_iterations, true, colours));
+	palette.colours.resize(max_iterations + 2);
+	for (uint n = 0; n < max_iterations + 2; n++)
+		palette.colours[n] = pack(colour_palette(n, false, colours));
+}
+
+std::shared_ptr<const palette_lut> palette_cache::get(const colouring& colours_, uint max_iterations)
+{
+	if (palette && palette->max_iterations == max_iterations && colours.palette == colours_.palette
+		&& colours.smooth == colours_.smooth && colours.contrast == colours_.contrast && colours.offset == colours_.offset)
+		return palette;
+
+	// a frame that is still being rendered (or cancelled but not stopped yet) keeps reading the old one
+	if (!palette || palette.use_count() > 1)
+		palette = std::make_shared<palette_lut>();
+	build_palette(colours_, max_iterations, *palette);
+	colours = colours_;
+	return palette;
+}
+
+static void colour_row_plain(const uint* iterations, uint count, const palette_lut& palette, sf::Uint8* pixels)
+{
+	for (uint i = 0; i < count; i++)
+	{
+		uint32_t colour = iterations[i] < palette.max_iterations ? palette.colours[iterations[i]] : palette.interior;
+		std::memcpy(pixels + 4 * i, &colour, 4);
+	}
+}
+
+#ifdef FRACTAL_SIMD_X86
+
+// 8 pixels at once, the colours are gathered from the table and the interior ones blended in
+
+__attribute__((target("avx2"))) static void colour_row_avx2(const uint* iterations, uint count, const palette_lut& palette, sf::Uint8* pixels)
+{
+	const int* table = reinterpret_cast<const int*>(palette.colours.data());
+	const __m256i max = _mm256_set1_epi32(palette.max_iterations);
+	const __m256i interior = _mm256_set1_epi32(palette.interior);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i index = _mm256_min_epu32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(iterations + i)), max);
+		__m256i inside = _mm256_cmpeq_epi32(index, max);
+		__m256i colour = _mm256_i32gather_epi32(table, index, 4);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels + 4 * i), _mm256_blendv_epi8(colour, interior, inside));
+	}
+	colour_row_plain(iterations + i, count - i, palette, pixels + 4 * i);
+}
+
+// the same with 16 pixels at once
+
+__attribute__((target("avx512f"))) static void colour_row_avx512(const uint* iterations, uint count, const palette_lut& palette, sf::Uint8* pixels)
+{
+	const int* table = reinterpret_cast<const int*>(palette.colours.data());
+	const __m512i max = _mm512_set1_epi32(palette.max_iterations);
+	const __m512i interior = _mm512_set1_epi32(palette.interior);
+
+	uint i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		// only the lanes below max_iterations are gathered, the rest keep the interior colour
+		__m512i index = _mm512_loadu_si512(iterations + i);
+		__mmask16 outside = _mm512_cmplt_epu32_mask(index, max);
+		_mm512_storeu_si512(pixels + 4 * i, _mm512_mask_i32gather_epi32(interior, outside, index, table, 4));
+	}
+	colour_row_plain(iterations + i, count - i, palette, pixels + 4 * i);
+}
+
+#endif
+
+// the colour kernel for the given instruction set, sse2 has no gather so it uses the scalar one
+
+colour_kernel select_colour_kernel(simd_level level)
+{
+#ifdef FRACTAL_SIMD_X86
+	switch (level)
+	{
+		case simd_level::avx2: return colour_row_avx2;
+		case simd_level::avx512: return colour_row_avx512;
+		case simd_level::sse2:
+		case simd_level::scalar:
+		default:
+			break;
+	}
+#else
+	UNUSED(level);
+#endif
+	return colour_row_plain;
+}
+
+// one channel blended between two packed colours
+
+static uint32_t blend(uint32_t a, uint32_t b, double f)
+{
+	uint32_t result = 0;
+	for (uint shift = 0; shift < 32; shift += 8)
+	{
+		double x = (a >> shift) & 0xff;
+		double y = (b >> shift) & 0xff;
+		result |= (uint32_t)(x + (y - x) * f + 0.5) << shift;
+	}
+	return result;
+}
+
+// the colourising pass, turns count pixels of the retained iterations (and last z) into RGBA
+// smooth colours need a logarithm per pixel, they are done one pixel at a time
+
+void colourise(const uint* iterations, const complex* last_z, uint count, const palette_lut& palette, sf::Uint8* pixels)
+{
+	if (!palette.smooth)
+	{
+		static const colour_kernel best = select_colour_kernel(detect_simd_level());
+		best(iterations, count, palette, pixels);
+		return;
+	}
+
+	for (uint i = 0; i < count; i++)
+	{
+		uint32_t colour = palette.interior;
+		if (iterations[i] < palette.max_iterations)
+		{
+			double value = smooth_iterations(iterations[i], last_z[i], palette.max_iterations);
+			uint n = std::min((uint)value, palette.max_iterations);
+			colour = blend(palette.colours[n], palette.colours[n + 1], std::min(value - n, 1.));
+		}
+		std::memcpy(pixels + 4 * i, &colour, 4);
+	}
+}
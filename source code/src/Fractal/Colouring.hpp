@@ -0,0 +1,63 @@
+#ifndef FRACTAL_COLOURING_HPP
+#define FRACTAL_COLOURING_HPP
+
+#include "Fractal/Complex.hpp"
+#include "Fractal/SimdKernels.hpp"
+
+// how the iterations of the pixels are turned into colours
+// the framebuffer keeps the iterations and the last z of every pixel, so changing any of this
+// only needs the pixels coloured again, not the fractal computed again
+
+// the palettes
+// 0 - classic, red, green and blue going up 1, 2 and 3 steps per iteration (the colours the program always had)
+// 1 - fire, a smooth gradient repeating every 64 iterations, the points inside the set are black
+// 2 - grey, from black to white and back every 128 iterations, the points inside the set are black
+
+const uint palette_count = 3;
+
+struct colouring
+{
+	uint palette = 0;
+	bool smooth = false; // fractional iterations from how far past the escape radius the last z got
+	double contrast = 1; // the iterations are multiplied by it before picking the colour
+	double offset = 0;	 // moves the colours along the palette, the colour cycling animation changes it
+};
+
+// the colours of a palette for every number of iterations of a frame, packed as RGBA bytes in memory order
+// colours[n] is the colour of n iterations, smooth colours blend colours[n] and colours[n + 1]
+// so there are max_iterations + 2 of them, the pixels that reach max_iterations get interior
+
+struct palette_lut
+{
+	uint max_iterations = 0;
+	bool smooth = false;
+	uint32_t interior = 0;
+	std::vector<uint32_t> colours;
+};
+
+// the palette of the last frame is kept, the next frames with the same colours and max_iterations share it
+// and a palette for different ones is built into its storage once no frame is using it anymore
+// get() is called from one thread only (the one starting the frames), the frames only read the palettes
+
+class palette_cache
+{
+public:
+	std::shared_ptr<const palette_lut> get(const colouring& colours, uint max_iterations);
+
+private:
+	std::shared_ptr<palette_lut> palette;
+	colouring colours;
+};
+
+// colours count pixels from their iterations with the lookup table, without smoothing
+
+typedef void (*colour_kernel)(const uint* iterations, uint count, const palette_lut& palette, sf::Uint8* pixels);
+
+double smooth_iterations(uint iterations, complex last_z, uint max_iterations);
+sf::Color colour_palette(double iterations, bool interior, const colouring& colours);
+palette_lut build_palette(const colouring& colours, uint max_iterations);
+void build_palette(const colouring& colours, uint max_iterations, palette_lut& palette);
+colour_kernel select_colour_kernel(simd_level level);
+void colourise(const uint* iterations, const complex* last_z, uint count, const palette_lut& palette, sf::Uint8* pixels);
+
+#endif // FRACTAL_COLOURING_HPP
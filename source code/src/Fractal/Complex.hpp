@@ -0,0 +1,12 @@
+#ifndef FRACTAL_COMPLEX_HPP
+#define FRACTAL_COMPLEX_HPP
+
+// complex number class for dealing with fractal generates via them
+
+struct complex
+{
+	double real;
+	double imag;
+};
+
+#endif // FRACTAL_COMPLEX_HPP
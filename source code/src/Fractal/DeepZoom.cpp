@@ -0,0 +1,142 @@
+#include "Fractal/DeepZoom.hpp"
+
+// number of 32 bit limbs after the point needed to move around by pixels of this size
+// (the bits the pixel size itself needs and 64 spare bits for the rounding errors of the reference orbit)
+
+uint deep_precision(double pixel)
+{
+	double bits = std::max(0., -std::log2(pixel)) + 64;
+	return (uint)(bits / 32) + 1;
+}
+
+// moving the centre of the view by some number of pixels (y grows downwards like in the window)
+
+void move_view(deep_view& view, double pixels_x, double pixels_y)
+{
+	uint limbs = std::max(deep_precision(std::min(view.pixel.real, view.pixel.imag)), big_precision(view.center_real));
+	big_set_precision(view.center_real, limbs);
+	big_set_precision(view.center_imag, limbs);
+
+	view.center_real = big_add(view.center_real, big_from_double(pixels_x * view.pixel.real, limbs));
+	view.center_imag = big_sub(view.center_imag, big_from_double(pixels_y * view.pixel.imag, limbs));
+}
+
+// function for calculating the corners of the window in doubles
+
+void view_corners(const deep_view& view, int width, int height, complex& top_left, complex& bottom_right)
+{
+	double center_real = big_to_double(view.center_real);
+	double center_imag = big_to_double(view.center_imag);
+
+	top_left.real = center_real - width / 2. * view.pixel.real;
+	top_left.imag = center_imag + height / 2. * view.pixel.imag;
+
+	bottom_right.real = center_real + width / 2. * view.pixel.real;
+	bottom_right.imag = center_imag - height / 2. * view.pixel.imag;
+}
+
+// below this size of a pixel the escape time functions in doubles start to show blocks
+
+bool needs_deep_zoom(const deep_view& view)
+{
+	return std::min(view.pixel.real, view.pixel.imag) < 1e-12;
+}
+
+//  function calculating the orbit of the reference point in high precision
+// returns Z_0 = 0, Z_1 = c, Z_2 = c^2 + c ... rounded to doubles, until it escapes or max_iterations is reached
+
+std::vector<complex> reference_orbit(const big_fixed& real, const big_fixed& imag, uint max_iterations)
+{
+	std::vector<complex> orbit;
+	orbit.reserve(max_iterations + 2);
+
+	big_fixed z_real = big_from_double(0, big_precision(real));
+	big_fixed z_imag = z_real;
+
+	complex point;
+	point.real = 0;
+	point.imag = 0;
+	orbit.push_back(point);
+
+	for (uint n = 0; n <= max_iterations; n++)
+	{
+		// Z = Z^2 + c
+		big_fixed square_real = big_mul(z_real, z_real);
+		big_fixed square_imag = big_mul(z_imag, z_imag);
+		big_fixed xy = big_mul(z_real, z_imag);
+
+		z_real = big_add(big_sub(square_real, square_imag), real);
+		z_imag = big_add(big_add(xy, xy), imag);
+
+		point.real = big_to_double(z_real);
+		point.imag = big_to_double(z_imag);
+		orbit.push_back(point);
+
+		if (point.real * point.real + point.imag * point.imag > 4)
+			break;
+	}
+
+	return orbit;
+}
+
+//  row kernel iterating the pixels as perturbations of the reference orbit
+// the positions in the job are relative to the reference point: dc = c - C
+// with z_n = Z_n + d_n the difference follows d_n+1 = (2 Z_n + d_n) d_n + dc, which stays accurate in doubles
+// when |z| gets smaller than |d| (or the reference escapes) the doubles would lose the pixel, this is the glitch
+// the orbit then gets rebased onto the start of the reference orbit (Z_0 = 0) with d = z
+// the count matches mendel_iter: iterations after z_1 = c until |z| reaches 2
+
+void perturbation_row(const row_job& job, uint* iterations)
+{
+	const complex* reference = job.reference;
+	const uint last = job.reference_length - 1;
+
+	for (uint i = 0; i < job.count; i++)
+	{
+		complex dc;
+		dc.real = job.origin_real + (job.x_begin + i * job.stride) * job.step;
+		dc.imag = job.imag;
+
+		// z_1 = c = Z_1 + dc
+		complex d = dc;
+		uint m = 1;
+		double z_real = reference[1].real + d.real;
+		double z_imag = reference[1].imag + d.imag;
+
+		uint iter = 0;
+		while (z_real * z_real + z_imag * z_imag < 4 && iter < job.max_iterations)
+		{
+			// the reference ends here (it escaped or reached max_iterations), it is never read past its last point
+			// a reference that escapes right away (just outside radius 2) gets here before the first step
+			if (m == last)
+			{
+				d.real = z_real;
+				d.imag = z_imag;
+				m = 0;
+			}
+
+			double t_real = 2 * reference[m].real + d.real;
+			double t_imag = 2 * reference[m].imag + d.imag;
+			double temp = t_real * d.real - t_imag * d.imag + dc.real;
+			d.imag = t_real * d.imag + t_imag * d.real + dc.imag;
+			d.real = temp;
+			m++;
+			iter++;
+
+			z_real = reference[m].real + d.real;
+			z_imag = reference[m].imag + d.imag;
+
+			// rebasing
+			if (z_real * z_real + z_imag * z_imag < d.real * d.real + d.imag * d.imag)
+			{
+				d.real = z_real;
+				d.imag = z_imag;
+				m = 0;
+			}
+		}
+
+		iterations[i] = iter;
+		if (job.last_z)
+			job.last_z[i] = { z_real, z_imag };
+	}
+}
@@ -0,0 +1,31 @@
+#ifndef FRACTAL_DEEP_ZOOM_HPP
+#define FRACTAL_DEEP_ZOOM_HPP
+
+#include "Fractal/BigFixed.hpp"
+#include "Fractal/SimdKernels.hpp"
+
+//
+//  deep zoom of the mandelbrot fractal with perturbation theory
+// past a zoom of about 1e13 doubles can't tell neighbouring pixels apart anymore, so the centre of the view
+// is kept in high precision, one reference orbit is iterated in high precision for the middle of the window
+// and every pixel only iterates its (small) difference from that orbit in doubles
+//
+
+// the view of the window with its centre kept in high precision
+// top_left and bottom_right that the rest of the program uses are derived from it with view_corners()
+
+struct deep_view
+{
+	big_fixed center_real;
+	big_fixed center_imag;
+	complex pixel = { 0, 0 }; // "lengths" of one pixel
+};
+
+uint deep_precision(double pixel);
+void move_view(deep_view& view, double pixels_x, double pixels_y);
+void view_corners(const deep_view& view, int width, int height, complex& top_left, complex& bottom_right);
+bool needs_deep_zoom(const deep_view& view);
+std::vector<complex> reference_orbit(const big_fixed& real, const big_fixed& imag, uint max_iterations);
+void perturbation_row(const row_job& job, uint* iterations);
+
+#endif // FRACTAL_DEEP_ZOOM_HPP
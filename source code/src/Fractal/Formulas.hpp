@@ -0,0 +1,114 @@
+#ifndef FRACTAL_FORMULAS_HPP
+#define FRACTAL_FORMULAS_HPP
+
+#include "Fractal/Kernels.hpp"
+#include "Fractal/SimdKernels.hpp"
+
+//
+//  the fractals as stateless types, the row kernels and the renderer are templates over them
+// so everything a fractal needs is picked at compile time and adding a fractal means adding a type here
+// (and its row kernels to row_kernels)
+//
+// julia	- z starts at the pixel and the julia parameter is added, otherwise z starts at c = pixel
+// absolute - the imaginary part is 2|a||b| instead of 2ab (burning ship)
+// cardioid - the points in the main cardioid and the period 2 bulb of the mandelbrot set are known to never escape
+// mirror	- which pixels are exact mirror images of others
+// kernel	- the row kernel of the fractal in row_kernels
+// connected() - whether the areas of the same iterations are connected, so mariani-silver subdivision is exact
+// operator() - the scalar escape time function of the fractal
+//
+
+enum class symmetry
+{
+	none,
+	real_axis, // the rows below the real axis are the rows above it
+	origin	   // the pixel on the other side of 0
+};
+
+struct mandelbrot_formula
+{
+	static constexpr bool julia = false;
+	static constexpr bool absolute = false;
+	static constexpr bool cardioid = true;
+	static constexpr symmetry mirror = symmetry::real_axis;
+	static constexpr row_kernel row_kernels::*kernel = &row_kernels::mandelbrot;
+
+	static bool connected(complex point, uint max_iterations)
+	{
+		UNUSED(point);
+		UNUSED(max_iterations);
+		return true;
+	}
+
+	uint operator()(complex pos, uint max_iterations, complex point, complex* last_z) const
+	{
+		UNUSED(point);
+		return mendel_iter(pos, max_iterations, last_z);
+	}
+};
+
+struct mandelbrot_julia_formula
+{
+	static constexpr bool julia = true;
+	static constexpr bool absolute = false;
+	static constexpr bool cardioid = false;
+	static constexpr symmetry mirror = symmetry::origin;
+	static constexpr row_kernel row_kernels::*kernel = &row_kernels::mandelbrot_julia;
+
+	// the julia sets of the parameters inside the mandelbrot set are connected
+	static bool connected(complex point, uint max_iterations)
+	{
+		return mendel_iter(point, max_iterations) == max_iterations;
+	}
+
+	uint operator()(complex pos, uint max_iterations, complex point, complex* last_z) const
+	{
+		return mandelbrot_julia_iter(pos, max_iterations, point, last_z);
+	}
+};
+
+struct burning_ship_formula
+{
+	static constexpr bool julia = false;
+	static constexpr bool absolute = true;
+	static constexpr bool cardioid = false;
+	static constexpr symmetry mirror = symmetry::none;
+	static constexpr row_kernel row_kernels::*kernel = &row_kernels::burning_ship;
+
+	// thin parts of it could be missed by the borders of the rectangles
+	static bool connected(complex point, uint max_iterations)
+	{
+		UNUSED(point);
+		UNUSED(max_iterations);
+		return false;
+	}
+
+	uint operator()(complex pos, uint max_iterations, complex point, complex* last_z) const
+	{
+		UNUSED(point);
+		return burning_ship_iter(pos, max_iterations, last_z);
+	}
+};
+
+struct burning_ship_julia_formula
+{
+	static constexpr bool julia = true;
+	static constexpr bool absolute = true;
+	static constexpr bool cardioid = false;
+	static constexpr symmetry mirror = symmetry::origin;
+	static constexpr row_kernel row_kernels::*kernel = &row_kernels::burning_ship_julia;
+
+	static bool connected(complex point, uint max_iterations)
+	{
+		UNUSED(point);
+		UNUSED(max_iterations);
+		return false;
+	}
+
+	uint operator()(complex pos, uint max_iterations, complex point, complex* last_z) const
+	{
+		return burning_ship_julia_iter(pos, max_iterations, point, last_z);
+	}
+};
+
+#endif // FRACTAL_FORMULAS_HPP
@@ -0,0 +1,476 @@
+#include "Fractal/Input.hpp"
+
+#include <chrono>
+
+// function for updating the julia parameter used in some fractals upon clicking
+
+void update_julia_param(complex& julia_param, int width, int height, complex top_left, complex bottom_right, sf::Vector2i mouse_pos)
+{
+	// calculating "lengths" of one pixel
+	complex d;
+	d.real = (bottom_right.real - top_left.real) / width;
+	d.imag = (top_left.imag - bottom_right.imag) / height;
+
+	julia_param.real = top_left.real + d.real * mouse_pos.x;
+	julia_param.imag = top_left.imag - d.imag * mouse_pos.y;
+}
+
+// function for calculating new parameters upon zooming
+// the view is moved and scaled in high precision, top_left and bottom_right are calculated from it
+// every notch of the wheel (delta of 1, a touchpad or a high resolution wheel turns it by fractions) zooms by zoom
+
+void zoom(deep_view& view, complex& top_left, complex& bottom_right, int width, int height, sf::Vector2i mouse_pos, double delta, double zoom, double& zoomlvl)
+{
+	// the place of the cursor becomes the middle of the window
+	move_view(view, mouse_pos.x - width / 2., mouse_pos.y - height / 2.);
+
+	// scaling the size of the pixels depending of the zoom, above 1 zooms in and below it zooms out
+	double scale = std::pow(zoom, delta);
+	view.pixel.real = view.pixel.real / scale;
+	view.pixel.imag = view.pixel.imag / scale;
+	zoomlvl = zoomlvl * scale;
+
+	view_corners(view, width, height, top_left, bottom_right);
+}
+
+// function for zooming exactly 2x so the new pixels lie on the grid of the old ones
+// the middle is moved to the pixel (or between the pixels) closest to the cursor where that is true,
+// then the renderer takes over every second pixel (zoom in) or a quarter of the frame (zoom out)
+
+void grid_zoom(deep_view& view, complex& top_left, complex& bottom_right, int width, int height, sf::Vector2i mouse_pos, double delta, double& zoomlvl)
+{
+	double move_x = mouse_pos.x - width / 2.;
+	double move_y = mouse_pos.y - height / 2.;
+
+	if (delta > 0) // zoom in, the new pixels are every half of an old one
+	{
+		move_x = (std::round(2 * move_x + width / 2.) - width / 2.) / 2;
+		move_y = (std::round(2 * move_y + height / 2.) - height / 2.) / 2;
+		move_view(view, move_x, move_y);
+		view.pixel.real = view.pixel.real / 2;
+		view.pixel.imag = view.pixel.imag / 2;
+		zoomlvl = zoomlvl * 2;
+	}
+	else // zoom out, the old pixels are every second new one
+	{
+		move_x = std::round(move_x - width / 2.) + width / 2.;
+		move_y = std::round(move_y - height / 2.) + height / 2.;
+		move_view(view, move_x, move_y);
+		view.pixel.real = view.pixel.real * 2;
+		view.pixel.imag = view.pixel.imag * 2;
+		zoomlvl = zoomlvl / 2;
+	}
+
+	view_corners(view, width, height, top_left, bottom_right);
+}
+
+// function for moving the view by whole pixels, the renderer only computes the strips that come into the window
+
+void pan(deep_view& view, complex& top_left, complex& bottom_right, int width, int height, int pixels_x, int pixels_y)
+{
+	move_view(view, pixels_x, pixels_y);
+	view_corners(view, width, height, top_left, bottom_right);
+}
+
+// function to reset the view back the begining
+
+void reset_view(deep_view& view, complex& top_left, complex& bottom_right, int width, int height, double& zoomlvl)
+{
+	zoomlvl = 1;
+
+	view.center_real = big_fixed();
+	view.center_imag = big_fixed();
+
+	// the window shows -2 to 2 on both axes
+	view.pixel.real = 4. / width;
+	view.pixel.imag = 4. / height;
+
+	view_corners(view, width, height, top_left, bottom_right);
+}
+
+// the keys that change what is rendered or how it is coloured, the other keys do nothing
+
+static void apply_key(explorer_state& state, sf::Keyboard::Key key, input_effect& effect)
+{
+	switch (key)
+	{
+		case sf::Keyboard::R:
+			reset_view(state.view, state.top_left, state.bottom_right, state.width, state.height, state.zoomlvl);
+			effect.update = true;
+			break;
+		// raising the iterations only continues the pixels that didn't escape yet, see which()
+		case sf::Keyboard::Add:
+		case sf::Keyboard::Equal:
+			state.max_iterations = std::min(state.max_iterations * 2, 1u << 20);
+			effect.update = true;
+			break;
+		case sf::Keyboard::Subtract:
+		case sf::Keyboard::Hyphen:
+			state.max_iterations = std::max(state.max_iterations / 2, 16u);
+			effect.update = true;
+			break;
+		// the arrows move the view by an eighth of the window
+		case sf::Keyboard::Left:
+		case sf::Keyboard::Right:
+			pan(state.view, state.top_left, state.bottom_right, state.width, state.height, (key == sf::Keyboard::Left ? -1 : 1) * (state.width / 8), 0);
+			effect.update = true;
+			break;
+		case sf::Keyboard::Up:
+		case sf::Keyboard::Down:
+			pan(state.view, state.top_left, state.bottom_right, state.width, state.height, 0, (key == sf::Keyboard::Up ? -1 : 1) * (state.height / 8));
+			effect.update = true;
+			break;
+		case sf::Keyboard::P:
+			state.colours.palette = (state.colours.palette + 1) % palette_count;
+			effect.recolour = true;
+			break;
+		case sf::Keyboard::S:
+			state.colours.smooth = !state.colours.smooth;
+			effect.recolour = true;
+			break;
+		case sf::Keyboard::C:
+			state.colour_cycling = !state.colour_cycling;
+			effect.cycling = true;
+			break;
+		case sf::Keyboard::Z:
+			state.grid_zooming = !state.grid_zooming;
+			break;
+		case sf::Keyboard::LBracket:
+			state.colours.contrast /= 1.25;
+			effect.recolour = true;
+			break;
+		case sf::Keyboard::RBracket:
+			state.colours.contrast *= 1.25;
+			effect.recolour = true;
+			break;
+		default:
+			break;
+	}
+}
+
+input_effect apply_input(explorer_state& state, const input_event& input)
+{
+	input_effect effect;
+	switch (input.kind)
+	{
+		case input_kind::wheel:
+			// turning the wheel there and back in the same pass changes nothing
+			if (input.delta == 0)
+				break;
+			if (state.grid_zooming)
+			{
+				// a 2x step for every whole notch (at least one), after the first one the cursor is in the middle
+				sf::Vector2i mouse_pos(input.x, input.y);
+				int steps = std::max((int)std::round(std::abs(input.delta)), 1);
+				for (int i = 0; i < steps; i++)
+				{
+					grid_zoom(state.view, state.top_left, state.bottom_right, state.width, state.height, mouse_pos, input.delta, state.zoomlvl);
+					mouse_pos = sf::Vector2i(state.width / 2, state.height / 2);
+				}
+			}
+			else
+				zoom(state.view, state.top_left, state.bottom_right, state.width, state.height, { input.x, input.y }, input.delta, 1.1, state.zoomlvl);
+			effect.update = true;
+			break;
+		case input_kind::pan:
+			pan(state.view, state.top_left, state.bottom_right, state.width, state.height, input.x, input.y);
+			effect.update = true;
+			break;
+		case input_kind::julia:
+			update_julia_param(state.julia_param, state.width, state.height, state.top_left, state.bottom_right, { input.x, input.y });
+			effect.update = state.which_one == 1 || state.which_one == 3;
+			break;
+		case input_kind::fractal:
+			state.which_one = (uint)std::min(std::max(input.value, 0), 3);
+			effect.update = true;
+			break;
+		case input_kind::key:
+			apply_key(state, (sf::Keyboard::Key)input.value, effect);
+			break;
+		case input_kind::resize:
+			// the wall that was dragged decides which way the middle moves, the window worked that out
+			move_view(state.view, input.move_x, input.move_y);
+			state.width = std::max(input.x, 1);
+			state.height = std::max(input.y, 1);
+			view_corners(state.view, state.width, state.height, state.top_left, state.bottom_right);
+			effect.update = true;
+			effect.resized = true;
+			break;
+		default:
+			break;
+	}
+	return effect;
+}
+
+// a burst of the wheel (a flick of a touchpad) comes as dozens of events in one pass of the loop,
+// they are added up into one zoom so the view changes (and is rendered) once, at the last place of the cursor
+
+void coalesce_wheel(std::vector<input_event>& inputs)
+{
+	std::vector<input_event> coalesced;
+	for (const input_event& input : inputs)
+	{
+		if (input.kind == input_kind::wheel && !coalesced.empty() && coalesced.back().kind == input_kind::wheel)
+		{
+			coalesced.back().delta += input.delta;
+			coalesced.back().x = input.x;
+			coalesced.back().y = input.y;
+		}
+		else
+			coalesced.push_back(input);
+	}
+	inputs.swap(coalesced);
+}
+
+// whether the size of the pixels is the one of the starting view (see reset_view()) zoomed 2x some number of times,
+// the wheel zooms by any factor and leaves it
+
+static bool on_zoom_ladder(const deep_view& view, int width)
+{
+	const double start = 4. / width;
+	return std::ldexp(start, std::ilogb(view.pixel.real) - std::ilogb(start)) == view.pixel.real;
+}
+
+frame_params state_frame(const explorer_state& state)
+{
+	frame_params frame;
+	frame.which_one = state.which_one;
+	frame.width = state.width;
+	frame.height = state.height;
+	frame.top_left = state.top_left;
+	frame.bottom_right = state.bottom_right;
+	frame.max_iterations = state.max_iterations;
+	frame.julia_param = state.julia_param;
+	// past the precision of doubles the mandelbrot fractal switches to perturbation
+	frame.deep = state.which_one == 0 && needs_deep_zoom(state.view);
+	frame.view = state.view;
+	// a rough picture shows up right away and gets sharper
+	frame.progressive = true;
+	// only the frames on the 2x zoom levels of the starting view (and the deep zooms) are met again
+	frame.recurring = frame.deep || on_zoom_ladder(state.view, state.width);
+	frame.colours = state.colours;
+	return frame;
+}
+
+// the names of the inputs in the order of input_kind
+
+static const char* input_names[] = { "wheel", "pan", "julia", "fractal", "key", "resize" };
+
+std::string format_input(const input_event& input)
+{
+	std::stringstream line;
+	line << std::fixed << std::setprecision(6) << input.time << ' ' << input_names[(int)input.kind];
+	line << std::defaultfloat << std::setprecision(17);
+	switch (input.kind)
+	{
+		case input_kind::wheel:
+			line << ' ' << input.delta << ' ' << input.x << ' ' << input.y;
+			break;
+		case input_kind::fractal:
+		case input_kind::key:
+			line << ' ' << input.value;
+			break;
+		case input_kind::resize:
+			line << ' ' << input.x << ' ' << input.y << ' ' << input.move_x << ' ' << input.move_y;
+			break;
+		default:
+			line << ' ' << input.x << ' ' << input.y;
+			break;
+	}
+	return line.str();
+}
+
+bool parse_input(const std::string& line, input_event& input)
+{
+	std::stringstream stream(line);
+	std::string name;
+	input = input_event();
+	if (!(stream >> input.time >> name) || !std::isfinite(input.time))
+		return false;
+	auto kind = std::find(std::begin(input_names), std::end(input_names), name);
+	if (kind == std::end(input_names))
+		return false;
+	input.kind = (input_kind)(kind - std::begin(input_names));
+
+	switch (input.kind)
+	{
+		case input_kind::wheel:
+			stream >> input.delta >> input.x >> input.y;
+			break;
+		case input_kind::fractal:
+		case input_kind::key:
+			stream >> input.value;
+			break;
+		case input_kind::resize:
+			stream >> input.x >> input.y >> input.move_x >> input.move_y;
+			break;
+		default:
+			stream >> input.x >> input.y;
+			break;
+	}
+	std::string rest;
+	return !stream.fail() && !(stream >> rest);
+}
+
+bool load_inputs(const std::string& path, std::vector<input_event>& inputs, std::string& error)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		error = "can't read " + path;
+		return false;
+	}
+	inputs.clear();
+	std::string line;
+	for (uint number = 1; std::getline(file, line); number++)
+	{
+		input_event input;
+		if (!parse_input(line, input) || (!inputs.empty() && input.time < inputs.back().time))
+		{
+			error = path + ":" + std::to_string(number) + ": not an input: " + line;
+			return false;
+		}
+		inputs.push_back(input);
+	}
+	return true;
+}
+
+bool input_recorder::open(const std::string& path)
+{
+	file.open(path, std::ios::trunc);
+	return (bool)file;
+}
+
+bool input_recorder::is_open() const
+{
+	return file.is_open();
+}
+
+void input_recorder::record(const input_event& input)
+{
+	if (file.is_open())
+		file << format_input(input) << '\n';
+}
+
+void latency_tracker::input(double time)
+{
+	if (oldest_input < 0)
+		oldest_input = time;
+}
+
+void latency_tracker::frame_started(double time, bool unfinished)
+{
+	double since = oldest_input >= 0 ? oldest_input : time;
+	if (unfinished)
+		since = std::min(since, shows_since);
+	shows_since = since;
+	oldest_input = -1;
+}
+
+void latency_tracker::frame_done(double time)
+{
+	latencies.push_back(time - shows_since);
+}
+
+// nearest rank, the p-th percentile is the smallest time at least p% of the times are at most
+
+percentiles time_percentiles(std::vector<double> times)
+{
+	percentiles result;
+	result.count = times.size();
+	if (times.empty())
+		return result;
+
+	std::sort(times.begin(), times.end());
+	auto rank = [&](double p) {
+		size_t index = (size_t)std::ceil(p / 100 * times.size());
+		return times[std::max(index, (size_t)1) - 1];
+	};
+	result.p50 = rank(50);
+	result.p95 = rank(95);
+	result.p99 = rank(99);
+	result.max = times.back();
+	return result;
+}
+
+std::string percentiles_text(const percentiles& times)
+{
+	std::stringstream text;
+	text << std::fixed << std::setprecision(1) << times.count << " frames, p50 " << times.p50 * 1000 << " ms, p95 "
+		 << times.p95 * 1000 << " ms, p99 " << times.p99 * 1000 << " ms, max " << times.max * 1000 << " ms";
+	return text.str();
+}
+
+// the same as the window does with its frames, only nothing is drawn
+
+uint replay_headless(const std::vector<input_event>& inputs, util::ThreadPool& pool, tile_cache* cache, latency_tracker& latency)
+{
+	explorer_state state;
+	reset_view(state.view, state.top_left, state.bottom_right, state.width, state.height, state.zoomlvl);
+
+	framebuffer target;
+	target.cache = cache;
+	target.resize(state.width, state.height);
+
+	auto start = std::chrono::steady_clock::now();
+	auto seconds = [&]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+
+	std::shared_ptr<render_job> job;
+	bool update = true;
+	bool measured = true;
+	uint frames = 0;
+	size_t next = 0;
+	std::vector<input_event> due; // the inputs of one pass
+	while (next < inputs.size() || update || !measured)
+	{
+		double now = seconds();
+		due.clear();
+		for (; next < inputs.size() && inputs[next].time <= now; next++)
+			due.push_back(inputs[next]);
+		coalesce_wheel(due);
+		for (const input_event& input : due)
+		{
+			input_effect effect = apply_input(state, input);
+			// the colours of a finished frame don't need a new frame, the window only colours it again
+			if (!effect.update)
+				continue;
+			update = true;
+			latency.input(input.time);
+			if (effect.resized)
+				target.resize(state.width, state.height);
+		}
+
+		// a frame that only computes the strips of a moved view is finished first, see main()
+		if (update && !(job && job->reused.width > 0 && !job->done()))
+		{
+			latency.frame_started(now, job && !job->done());
+			job = which(pool, target, state_frame(state));
+			update = false;
+			measured = false;
+			frames++;
+		}
+
+		finished_tile tile;
+		while (target.finished->pop(tile))
+			;
+		if (!measured && job->done())
+		{
+			if (!job->cancelled())
+				latency.frame_done(seconds());
+			measured = true;
+		}
+
+		// nothing to do until the next input or the end of the frame, the thread sleeps so all the processors
+		// are left to the pool (without an input left it wakes up every second only to wait again)
+		auto until = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+		if (next < inputs.size())
+			until = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(inputs[next].time));
+		if (job && !job->done())
+			target.wait_done(*job, until);
+		else if (measured && !update && next < inputs.size())
+			std::this_thread::sleep_until(until);
+	}
+
+	target.wait_idle();
+	return frames;
+}
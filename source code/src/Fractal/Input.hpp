@@ -0,0 +1,141 @@
+#ifndef FRACTAL_INPUT_HPP
+#define FRACTAL_INPUT_HPP
+
+#include "Fractal/Render.hpp"
+
+//
+//  the inputs that change what the window shows, so a session can be recorded and played back the same way
+// the window turns the sfml events into inputs (a click on a button of the side panel is a fractal input,
+// a click anywhere else a julia input ...) and applies them to its state with apply_input(), a replay applies
+// the recorded inputs to the same state at the same times, with a window or without one
+//
+//  explorer --record session.txt               the window as usual, every input is written into the file
+//  explorer --replay session.txt [--headless]   the recorded inputs instead of the mouse and the keyboard
+//
+// recording and replaying always start from the starting view of an 800 x 800 window, the replay ends when
+// the last input was applied and its frame finished, then the input to frame latencies are printed
+// (from the oldest input a frame shows to the last tile of that frame)
+//
+// one input per line of the file: the seconds since the start, the name and the values
+//  wheel delta x y       the wheel was turned by delta with the cursor at x, y (all the turns of one pass of the loop)
+//  pan x y               the view was dragged by x, y pixels
+//  julia x y             the julia parameter was picked at x, y
+//  fractal n             the fractal was switched to n (which_one)
+//  key code              a key that changes the view or the colours (sf::Keyboard::Key)
+//  resize w h dx dy      the window was resized to w x h, the middle of the view moved by dx, dy pixels
+//
+
+enum class input_kind
+{
+	wheel,
+	pan,
+	julia,
+	fractal,
+	key,
+	resize
+};
+
+struct input_event
+{
+	double time = 0;
+	input_kind kind = input_kind::key;
+	int x = 0; // the cursor, the pixels dragged by or the new size of the window
+	int y = 0;
+	double delta = 0; // how far the wheel was turned
+	double move_x = 0; // resize only: how far the middle of the view moved
+	double move_y = 0;
+	int value = 0; // the fractal or the key
+};
+
+// the part of the state of the window that decides what is rendered
+
+struct explorer_state
+{
+	uint which_one = 0; // which fractal is being displayed
+	int width = 800;
+	int height = 800;
+	uint max_iterations = 255;
+	complex julia_param = { 0, 0 };
+	// the displayed area, the view keeps its middle in high precision for deep zooms
+	deep_view view;
+	complex top_left;
+	complex bottom_right;
+	double zoomlvl = 1;
+	// zooming 2x on the grid of the pixels reuses the pixels of the last frame
+	bool grid_zooming = false;
+	// how the iterations are coloured, changing it only colours the finished frame again
+	colouring colours;
+	bool colour_cycling = false;
+};
+
+// what an input changed
+struct input_effect
+{
+	bool update = false;   // the fractal has to be rendered again
+	bool recolour = false; // only the colours
+	bool resized = false;
+	bool cycling = false; // colour cycling was switched on or off
+};
+
+void update_julia_param(complex& julia_param, int width, int height, complex top_left, complex bottom_right, sf::Vector2i mouse_pos);
+void zoom(deep_view& view, complex& top_left, complex& bottom_right, int width, int height, sf::Vector2i mouse_pos, double delta, double zoom, double& zoomlvl);
+void grid_zoom(deep_view& view, complex& top_left, complex& bottom_right, int width, int height, sf::Vector2i mouse_pos, double delta, double& zoomlvl);
+void pan(deep_view& view, complex& top_left, complex& bottom_right, int width, int height, int pixels_x, int pixels_y);
+void reset_view(deep_view& view, complex& top_left, complex& bottom_right, int width, int height, double& zoomlvl);
+
+input_effect apply_input(explorer_state& state, const input_event& input);
+// the wheel inputs right after each other become one with the sum of their deltas
+void coalesce_wheel(std::vector<input_event>& inputs);
+// the frame the window renders for the state
+frame_params state_frame(const explorer_state& state);
+
+std::string format_input(const input_event& input);
+bool parse_input(const std::string& line, input_event& input);
+// false when the file can't be read or a line isn't an input
+bool load_inputs(const std::string& path, std::vector<input_event>& inputs, std::string& error);
+
+class input_recorder
+{
+public:
+	bool open(const std::string& path);
+	bool is_open() const;
+	void record(const input_event& input);
+
+private:
+	std::ofstream file;
+};
+
+// the latency of every frame that was rendered to the end, from the oldest input it shows to its last tile
+// a frame that is cancelled by a newer one passes its inputs on to it
+
+class latency_tracker
+{
+public:
+	void input(double time);
+	// unfinished - the frame before it wasn't done yet and gets cancelled
+	void frame_started(double time, bool unfinished);
+	void frame_done(double time);
+
+	std::vector<double> latencies;
+
+private:
+	double oldest_input = -1; // the oldest input no frame was started for yet, -1 when none
+	double shows_since = 0;	  // the oldest input the frame being rendered shows
+};
+
+struct percentiles
+{
+	size_t count = 0;
+	double p50 = 0;
+	double p95 = 0;
+	double p99 = 0;
+	double max = 0;
+};
+
+percentiles time_percentiles(std::vector<double> times);
+std::string percentiles_text(const percentiles& times);
+
+// the inputs at their times without a window, returns the number of frames that were started
+uint replay_headless(const std::vector<input_event>& inputs, util::ThreadPool& pool, tile_cache* cache, latency_tracker& latency);
+
+#endif // FRACTAL_INPUT_HPP
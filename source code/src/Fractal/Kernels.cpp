@@ -0,0 +1,244 @@
+#include "Fractal/Kernels.hpp"
+
+// points inside the main cardioid and the biggest circle on its left never escape
+
+bool in_cardioid_or_bulb(complex c)
+{
+	double y_square = c.imag * c.imag;
+	double x = c.real - 0.25;
+	double q = x * x + y_square;
+	if (q * (q + x) < 0.25 * y_square)
+		return true;
+
+	return (c.real + 1) * (c.real + 1) + y_square < 0.0625;
+}
+
+// the pixel is known to never escape
+
+static void never_escapes(complex* last_z)
+{
+	if (last_z)
+		*last_z = interior_z;
+}
+
+// function for calculating the number of iterations for some position pos in mandelbrot fractal
+
+uint mendel_iter(complex pos, uint max_iterations, complex* last_z)
+{
+	// some variables that are used in the function or are used 2 times to slightly speed up the process
+	complex pos_copy = pos;
+	complex square;
+	square.real = pos.real * pos.real;
+	square.imag = pos.imag * pos.imag;
+	double xy = pos.imag * pos.real;
+
+	if (in_cardioid_or_bulb(pos))
+	{
+		never_escapes(last_z);
+		return max_iterations;
+	}
+
+	uint iter = 0;
+	// z saved for the periodicity check
+	complex saved = pos;
+	uint period = 1;
+	uint since_saved = 0;
+
+	// the formula for the mendelbrot fractal is z = z^2 + z0
+	// z is a complex number
+	// z0 is a starting number in this function 'pos'
+
+	while (square.real + square.imag < 4 && iter < max_iterations) // condition for escaping
+	{
+		// calculating z^2 + z0
+		double temp = square.real - square.imag + pos_copy.real;
+		pos.imag = xy + xy + pos_copy.imag;
+		pos.real = temp;
+		iter++;
+		// the orbit is in a cycle, it will never escape
+		if (pos.real == saved.real && pos.imag == saved.imag)
+		{
+			never_escapes(last_z);
+			return max_iterations;
+		}
+		if (++since_saved == period)
+		{
+			saved = pos;
+			since_saved = 0;
+			period *= 2;
+		}
+		//calculating the squared values for the check and the next iteration
+		square.real = pos.real * pos.real;
+		square.imag = pos.imag * pos.imag;
+		xy = pos.imag * pos.real;
+	}
+
+	if (last_z)
+		*last_z = pos;
+	return iter;
+}
+
+// function for calculating the number of iterations for some position pos in julia version of mandelbrot fractal with some point
+
+uint mandelbrot_julia_iter(complex pos, uint max_iterations, complex point, complex* last_z)
+{
+	//some variables for slight optimization
+	complex square;
+	square.real = pos.real * pos.real;
+	square.imag = pos.imag * pos.imag;
+	double xy = pos.real * pos.imag;
+	uint iter = 0;
+	complex saved = pos;
+	uint period = 1;
+	uint since_saved = 0;
+	while (square.real + square.imag < 4 && iter < max_iterations) // escape condition
+	{
+		// z = z^2 + z_p
+		double temp = square.real - square.imag + point.real;
+		pos.imag = xy + xy + point.imag;
+		pos.real = temp;
+		iter++;
+		// the orbit is in a cycle, it will never escape
+		if (pos.real == saved.real && pos.imag == saved.imag)
+		{
+			never_escapes(last_z);
+			return max_iterations;
+		}
+		if (++since_saved == period)
+		{
+			saved = pos;
+			since_saved = 0;
+			period *= 2;
+		}
+		// calculating the square for the check the next iteration
+		square.real = pos.real * pos.real;
+		square.imag = pos.imag * pos.imag;
+		xy = pos.real * pos.imag;
+	}
+
+	if (last_z)
+		*last_z = pos;
+	return iter;
+}
+
+// function for calculating the number of iterations for some position pos of burning ship fractal
+
+uint burning_ship_iter(complex pos, uint max_iterations, complex* last_z)
+{
+	// come variables for slight performance increase
+	complex copy = pos;
+	complex square;
+	square.real = pos.real * pos.real;
+	square.imag = pos.imag * pos.imag;
+	uint iter = 0;
+	complex saved = pos;
+	uint period = 1;
+	uint since_saved = 0;
+	while (square.real + square.imag < 4 && iter < max_iterations)
+	{
+		// z = (|a| + |b|i)^2 + z0
+		double temp = square.real - square.imag + copy.real;
+		pos.imag = 2 * std::abs(pos.real) * std::abs(pos.imag) + copy.imag;
+		pos.real = temp;
+		iter++;
+		// the orbit is in a cycle, it will never escape
+		if (pos.real == saved.real && pos.imag == saved.imag)
+		{
+			never_escapes(last_z);
+			return max_iterations;
+		}
+		if (++since_saved == period)
+		{
+			saved = pos;
+			since_saved = 0;
+			period *= 2;
+		}
+		// calculating the square for the check and the next iteration
+		square.real = pos.real * pos.real;
+		square.imag = pos.imag * pos.imag;
+	}
+	if (last_z)
+		*last_z = pos;
+	return iter;
+}
+
+// function for calculating the number of iterations for some position pos in julia version of burning ship fractal with some point
+
+uint burning_ship_julia_iter(complex pos, uint max_iterations, complex point, complex* last_z)
+{
+	// variables for slight performance increase
+	uint iter = 0;
+	complex square;
+	square.real = pos.real * pos.real;
+	square.imag = pos.imag * pos.imag;
+	complex saved = pos;
+	uint period = 1;
+	uint since_saved = 0;
+	while (square.real + square.imag < 4 && iter < max_iterations)
+	{
+		// z = (|a| + |b|i)^2 + z_p
+		double temp = square.real - square.imag + point.real;
+		pos.imag = 2 * std::abs(pos.real) * std::abs(pos.imag) + point.imag;
+		pos.real = temp;
+		iter++;
+		// the orbit is in a cycle, it will never escape
+		if (pos.real == saved.real && pos.imag == saved.imag)
+		{
+			never_escapes(last_z);
+			return max_iterations;
+		}
+		if (++since_saved == period)
+		{
+			saved = pos;
+			since_saved = 0;
+			period *= 2;
+		}
+		// calculating squares for the check and the next iteration
+		square.real = pos.real * pos.real;
+		square.imag = pos.imag * pos.imag;
+	}
+	if (last_z)
+		*last_z = pos;
+	return iter;
+}
+
+// function continuing the orbit of a pixel that reached the old max_iterations up to the new one
+// z and iter are where the orbit stopped, c is the pixel (or the julia parameter for the julia fractals)
+// does the same arithmetic as the functions above, so the result is the same as iterating from the start
+// z is left at the last z of the orbit
+
+uint resume_iter(complex c, complex& z, uint iter, uint max_iterations, bool burning)
+{
+	complex square;
+	square.real = z.real * z.real;
+	square.imag = z.imag * z.imag;
+	double xy = z.real * z.imag;
+	complex saved = z;
+	uint period = 1;
+	uint since_saved = 0;
+	while (square.real + square.imag < 4 && iter < max_iterations)
+	{
+		double temp = square.real - square.imag + c.real;
+		if (burning)
+			z.imag = 2 * std::abs(z.real) * std::abs(z.imag) + c.imag;
+		else
+			z.imag = xy + xy + c.imag;
+		z.real = temp;
+		iter++;
+		if (z.real == saved.real && z.imag == saved.imag)
+		{
+			z = interior_z;
+			return max_iterations;
+		}
+		if (++since_saved == period)
+		{
+			saved = z;
+			since_saved = 0;
+			period *= 2;
+		}
+		square.real = z.real * z.real;
+		square.imag = z.imag * z.imag;
+		xy = z.real * z.imag;
+	}
+	return iter;
+}
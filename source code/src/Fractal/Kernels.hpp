@@ -0,0 +1,33 @@
+#ifndef FRACTAL_KERNELS_HPP
+#define FRACTAL_KERNELS_HPP
+
+#include "Fractal/Complex.hpp"
+
+//
+//  scalar escape time functions, each one handles a single pixel
+// they return the number of iterations it takes for the point pos to escape (at most max_iterations)
+//
+// two shortcuts end the points that never escape early, neither of them changes the result:
+// the mandelbrot points in the main cardioid and the period 2 bulb are recognised with a formula,
+// and an orbit that comes back to exactly the same z is in a cycle (checked brent style, the saved z
+// is replaced after 1, 2, 4, 8 ... iterations so cycles of any length are found)
+//
+// when last_z is given the last z of the orbit is written there, so the pixel can be continued by resume_iter()
+// after max_iterations is raised (or coloured smoothly after it escaped)
+//
+
+// markers written into last_z instead of a z
+// interior - the orbit never escapes (cardioid, bulb or a cycle), unknown - the pixel was filled in without iterating it
+
+const complex interior_z = { NAN, NAN };
+const complex unknown_z = { INFINITY, INFINITY };
+
+bool in_cardioid_or_bulb(complex c);
+
+uint mendel_iter(complex pos, uint max_iterations, complex* last_z = nullptr);
+uint mandelbrot_julia_iter(complex pos, uint max_iterations, complex point, complex* last_z = nullptr);
+uint burning_ship_iter(complex pos, uint max_iterations, complex* last_z = nullptr);
+uint burning_ship_julia_iter(complex pos, uint max_iterations, complex point, complex* last_z = nullptr);
+uint resume_iter(complex c, complex& z, uint iter, uint max_iterations, bool burning);
+
+#endif // FRACTAL_KERNELS_HPP
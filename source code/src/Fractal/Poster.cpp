@@ -0,0 +1,460 @@
+#include "Fractal/Poster.hpp"
+
+static bool has_extension(const std::string& path, const std::string& extension)
+{
+	std::string end = path.size() >= extension.size() ? path.substr(path.size() - extension.size()) : "";
+	std::transform(end.begin(), end.end(), end.begin(), ::tolower);
+	return end == extension;
+}
+
+// the RGB bytes of count RGBA pixels
+
+static void drop_alpha(const sf::Uint8* rgba, size_t count, sf::Uint8* rgb)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		rgb[3 * i] = rgba[4 * i];
+		rgb[3 * i + 1] = rgba[4 * i + 1];
+		rgb[3 * i + 2] = rgba[4 * i + 2];
+	}
+}
+
+//
+//  binary ppm, just the size and the RGB bytes
+//
+
+class ppm_writer : public image_writer
+{
+public:
+	ppm_writer(const std::string& path, uint width_, uint height_) :
+		file(path, std::ios::binary | std::ios::trunc),
+		width(width_)
+	{
+		file << "P6\n"
+			 << width << ' ' << height_ << "\n255\n";
+	}
+
+	bool write_rows(const sf::Uint8* rgba, uint count) override
+	{
+		row.resize(3 * (size_t)width);
+		for (uint y = 0; y < count && file; y++)
+		{
+			drop_alpha(rgba + 4 * (size_t)width * y, width, row.data());
+			file.write((const char*)row.data(), row.size());
+		}
+		return (bool)file;
+	}
+
+	bool finish() override
+	{
+		file.close();
+		return !file.fail();
+	}
+
+	std::ofstream file;
+
+private:
+	uint width;
+	std::vector<sf::Uint8> row;
+};
+
+//
+//  png without compression
+// the image data of a png is a zlib stream, deflate can store the bytes as they are in blocks of up to 65535 bytes
+// so the file is written without a compression library, the stream is cut into IDAT chunks of about a megabyte
+// (the files are about as big as the pixels, there is no zlib in the dependencies of the project)
+//
+
+// the zlib stream goes into an IDAT chunk once there is this much of it, so the writer never keeps more than
+// that and a block, and no chunk gets anywhere near the 2^31 - 1 bytes a png chunk can have
+static const size_t png_idat_bytes = 1 << 20;
+
+static std::vector<uint> make_crc_table()
+{
+	std::vector<uint> table(256);
+	for (uint n = 0; n < 256; n++)
+	{
+		uint c = n;
+		for (uint k = 0; k < 8; k++)
+			c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+		table[n] = c;
+	}
+	return table;
+}
+
+static uint crc32(uint crc, const sf::Uint8* data, size_t length)
+{
+	static const std::vector<uint> crc_table = make_crc_table();
+	crc = ~crc;
+	for (size_t i = 0; i < length; i++)
+		crc = crc_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	return ~crc;
+}
+
+static void put_big_endian(std::vector<sf::Uint8>& out, uint value)
+{
+	for (int shift = 24; shift >= 0; shift -= 8)
+		out.push_back((sf::Uint8)(value >> shift));
+}
+
+class png_writer : public image_writer
+{
+public:
+	png_writer(const std::string& path, uint width_, uint height) :
+		file(path, std::ios::binary | std::ios::trunc),
+		width(width_)
+	{
+		static const sf::Uint8 signature[8] = { 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+		file.write((const char*)signature, sizeof(signature));
+
+		// 8 bits per channel, RGB, no interlacing
+		std::vector<sf::Uint8> header;
+		put_big_endian(header, width);
+		put_big_endian(header, height);
+		header.insert(header.end(), { 8, 2, 0, 0, 0 });
+		chunk("IHDR", header);
+
+		// zlib header, deflate with a 32k window and no dictionary
+		compressed = { 0x78, 0x01 };
+	}
+
+	bool write_rows(const sf::Uint8* rgba, uint count) override
+	{
+		std::vector<sf::Uint8> row(1 + 3 * (size_t)width);
+		row[0] = 0; // no filter
+		for (uint y = 0; y < count; y++)
+		{
+			drop_alpha(rgba + 4 * (size_t)width * y, width, row.data() + 1);
+			add(row.data(), row.size());
+		}
+		return flush();
+	}
+
+	bool finish() override
+	{
+		// the last block is marked as the final one even when it is empty
+		block(true);
+		put_big_endian(compressed, (adler_b << 16) | adler_a);
+		flush();
+		chunk("IEND", {});
+		file.close();
+		return !file.fail();
+	}
+
+	std::ofstream file;
+
+private:
+	uint width;
+	std::vector<sf::Uint8> pending;	   // bytes of the next stored block
+	std::vector<sf::Uint8> compressed; // the zlib stream that wasn't written into an IDAT chunk yet
+	uint adler_a = 1;
+	uint adler_b = 0;
+
+	// the length, the type, the data and the crc of the type and the data
+	void chunk(const char* type, const std::vector<sf::Uint8>& data)
+	{
+		std::vector<sf::Uint8> out;
+		put_big_endian(out, (uint)data.size());
+		out.insert(out.end(), type, type + 4);
+		uint crc = crc32(crc32(0, out.data() + 4, 4), data.data(), data.size());
+		file.write((const char*)out.data(), out.size());
+		file.write((const char*)data.data(), data.size());
+		out.clear();
+		put_big_endian(out, crc);
+		file.write((const char*)out.data(), out.size());
+	}
+
+	void add(const sf::Uint8* data, size_t length)
+	{
+		// adler-32 of the uncompressed bytes, the sums are reduced every 5552 bytes before they can overflow
+		for (size_t i = 0; i < length;)
+		{
+			size_t end = std::min(length, i + 5552);
+			for (; i < end; i++)
+			{
+				adler_a += data[i];
+				adler_b += adler_a;
+			}
+			adler_a %= 65521;
+			adler_b %= 65521;
+		}
+
+		while (length > 0)
+		{
+			size_t part = std::min(length, 65535 - pending.size());
+			pending.insert(pending.end(), data, data + part);
+			data += part;
+			length -= part;
+			if (pending.size() == 65535)
+				block(false);
+		}
+	}
+
+	// a stored block: the final flag and type 00 (the rest of the byte is padding), the length and its complement
+	void block(bool final)
+	{
+		uint length = (uint)pending.size();
+		compressed.push_back(final ? 1 : 0);
+		compressed.push_back(length & 0xff);
+		compressed.push_back(length >> 8);
+		compressed.push_back(~length & 0xff);
+		compressed.push_back((~length >> 8) & 0xff);
+		compressed.insert(compressed.end(), pending.begin(), pending.end());
+		pending.clear();
+		if (compressed.size() >= png_idat_bytes)
+			flush();
+	}
+
+	bool flush()
+	{
+		if (!compressed.empty())
+			chunk("IDAT", compressed);
+		compressed.clear();
+		return (bool)file;
+	}
+};
+
+//
+//  uncompressed tiff, one strip per row
+// the strips are written as the rows come, the directory of the tags goes after them at the end and the header
+// is pointed to it, past 4 gigabytes the file is a BigTIFF (64 bit offsets)
+//
+
+class tiff_writer : public image_writer
+{
+public:
+	tiff_writer(const std::string& path, uint width_, uint height_) :
+		file(path, std::ios::binary | std::ios::trunc),
+		width(width_),
+		height(height_)
+	{
+		big = (ullong)width * height * 3 > 4000000000ULL;
+		file.write("II", 2);
+		if (big)
+		{
+			put(43, 2);
+			put(8, 2); // size of the offsets
+			put(0, 2);
+			put(0, 8); // offset of the directory, written at the end
+		}
+		else
+		{
+			put(42, 2);
+			put(0, 4);
+		}
+		data_start = big ? 16 : 8;
+	}
+
+	bool write_rows(const sf::Uint8* rgba, uint count) override
+	{
+		row.resize(3 * (size_t)width);
+		for (uint y = 0; y < count && file; y++)
+		{
+			drop_alpha(rgba + 4 * (size_t)width * y, width, row.data());
+			file.write((const char*)row.data(), row.size());
+		}
+		return (bool)file;
+	}
+
+	bool finish() override
+	{
+		const ullong strip = 3 * (ullong)width;
+		ullong directory = data_start + strip * height;
+		if (directory % 2 == 1)
+		{
+			file.put(0);
+			directory++;
+		}
+
+		// the tags in ascending order, the arrays of the strips follow the directory
+		const uint entries = 10;
+		const uint entry_size = big ? 20 : 12;
+		ullong arrays = directory + (big ? 8 : 2) + entries * entry_size + (big ? 8 : 4);
+		ullong offsets = arrays;
+		ullong counts = arrays + (ullong)height * (big ? 8 : 4);
+
+		const uint short_type = 3;
+		const uint long_type = 4;
+		const uint offset_type = big ? 16 : 4;
+		put(entries, big ? 8 : 2);
+		entry(256, long_type, 1, width);
+		entry(257, long_type, 1, height);
+		entry(258, short_type, 3, big ? (8ULL | 8ULL << 16 | 8ULL << 32) : 0); // bits per sample, inline in a BigTIFF
+		entry(259, short_type, 1, 1);										  // no compression
+		entry(262, short_type, 1, 2);										  // RGB
+		entry(273, offset_type, height, height == 1 ? data_start : offsets);
+		entry(277, short_type, 1, 3);
+		entry(278, long_type, 1, 1); // rows per strip
+		entry(279, offset_type, height, height == 1 ? strip : counts);
+		entry(284, short_type, 1, 1); // the channels of a pixel together
+		put(0, big ? 8 : 4);
+
+		// the arrays of the strips, a single strip was written into the entries themselves
+		for (uint y = 0; y < height && height > 1; y++)
+			put(data_start + strip * y, big ? 8 : 4);
+		for (uint y = 0; y < height && height > 1; y++)
+			put(strip, big ? 8 : 4);
+		// the 3 shorts of bits per sample don't fit into a classic entry, they go after the arrays
+		if (!big)
+		{
+			bits_per_sample = (ullong)file.tellp();
+			put(8, 2);
+			put(8, 2);
+			put(8, 2);
+			// the entry written before pointed nowhere, now it can point here
+			file.seekp(directory + 2 + 2 * entry_size + 8);
+			put(bits_per_sample, 4);
+		}
+
+		file.seekp(big ? 8 : 4);
+		put(directory, big ? 8 : 4);
+		file.close();
+		return !file.fail();
+	}
+
+	std::ofstream file;
+
+private:
+	uint width;
+	uint height;
+	bool big;
+	ullong data_start;
+	ullong bits_per_sample = 0;
+	std::vector<sf::Uint8> row;
+
+	// little endian
+	void put(ullong value, uint bytes)
+	{
+		for (uint i = 0; i < bytes; i++)
+			file.put((char)(value >> (8 * i)));
+	}
+
+	// the values of one element are stored in the entry itself (shorts in the low bytes)
+	void entry(uint tag, uint type, ullong count, ullong value)
+	{
+		put(tag, 2);
+		put(type, 2);
+		put(count, big ? 8 : 4);
+		put(value, big ? 8 : 4);
+	}
+};
+
+bool can_stream(const std::string& path)
+{
+	return has_extension(path, ".png") || has_extension(path, ".tif") || has_extension(path, ".tiff") || has_extension(path, ".ppm");
+}
+
+std::unique_ptr<image_writer> open_image_writer(const std::string& path, uint width, uint height)
+{
+	if (has_extension(path, ".png"))
+	{
+		auto writer = std::make_unique<png_writer>(path, width, height);
+		return writer->file ? std::move(writer) : nullptr;
+	}
+	if (has_extension(path, ".tif") || has_extension(path, ".tiff"))
+	{
+		auto writer = std::make_unique<tiff_writer>(path, width, height);
+		return writer->file ? std::move(writer) : nullptr;
+	}
+	if (has_extension(path, ".ppm"))
+	{
+		auto writer = std::make_unique<ppm_writer>(path, width, height);
+		return writer->file ? std::move(writer) : nullptr;
+	}
+	return nullptr;
+}
+
+// the most any of the writers keeps besides the rows it is given: a row without alpha and for the png
+// the zlib stream that isn't in an IDAT chunk yet and the block being filled
+
+size_t poster_writer_bytes(uint width)
+{
+	return 1 + 3 * (size_t)width + png_idat_bytes + 2 * (65535 + 5);
+}
+
+// two bands are in memory at once, every pixel of a band takes the pixel, its iterations and last z
+// in the framebuffer and the pixel again in the rows handed to the writer
+static const size_t poster_pixel_bytes = 2 * (4 + sizeof(uint) + sizeof(complex)) + 4;
+
+size_t poster_memory(uint width, uint rows)
+{
+	return poster_pixel_bytes * width * rows + poster_writer_bytes(width);
+}
+
+// the number of rows of a band, a whole number of tiles so no tile is cut in half, the writer takes the rest
+
+uint poster_band_height(uint width, uint height, size_t band_memory)
+{
+	const size_t writer = poster_writer_bytes(width);
+	size_t rows = (band_memory > writer ? band_memory - writer : 0) / (poster_pixel_bytes * width) / tile_size * tile_size;
+	return (uint)std::min<size_t>(rows, height);
+}
+
+// one band being rendered
+
+struct poster_band
+{
+	std::unique_ptr<framebuffer> target;
+	std::shared_ptr<render_job> job;
+	uint top = 0;
+	uint height = 0;
+};
+
+// the band is the part of the view of the frame with its rows, moved in high precision like the window moves
+// its view so the bands line up and deep zoom posters work the same way
+
+static poster_band start_band(util::ThreadPool& pool, const frame_params& frame, tile_cache* cache, uint top, uint height)
+{
+	frame_params part = frame;
+	part.height = height;
+	part.progressive = false;
+	move_view(part.view, 0, top + height / 2. - frame.height / 2.);
+	view_corners(part.view, part.width, part.height, part.top_left, part.bottom_right);
+
+	poster_band band;
+	band.top = top;
+	band.height = height;
+	band.target = std::make_unique<framebuffer>();
+	band.target->cache = cache;
+	band.target->resize(part.width, part.height);
+	band.job = which(pool, *band.target, part);
+	return band;
+}
+
+// the view of the frame has to be set (frame.view), the corners are taken from it
+// the next band is rendered while the finished one is written
+
+bool render_poster(util::ThreadPool& pool, const frame_params& frame, tile_cache* cache, image_writer& writer, size_t band_memory)
+{
+	const uint band_height = poster_band_height(frame.width, frame.height, band_memory);
+	if (band_height == 0)
+		return false;
+	std::vector<sf::Uint8> rows((size_t)frame.width * band_height * 4);
+
+	poster_band current = start_band(pool, frame, cache, 0, band_height);
+	while (current.height > 0)
+	{
+		current.target->wait_idle();
+		if (current.job->cancelled())
+			return false;
+
+		poster_band next;
+		uint next_top = current.top + current.height;
+		if (next_top < frame.height)
+			next = start_band(pool, frame, cache, next_top, std::min(band_height, frame.height - next_top));
+
+		read_rows(*current.target, 0, current.height, rows.data());
+		current.target.reset();
+		if (!writer.write_rows(rows.data(), current.height))
+		{
+			if (next.job)
+			{
+				next.target->cancel();
+				next.target->wait_idle();
+			}
+			return false;
+		}
+		current = std::move(next);
+	}
+	return writer.finish();
+}
@@ -0,0 +1,39 @@
+#ifndef FRACTAL_POSTER_HPP
+#define FRACTAL_POSTER_HPP
+
+#include "Fractal/Render.hpp"
+
+//
+//  rendering images of any size (100000 x 100000 and more) in horizontal bands
+// every band is a frame of its own, as wide as the image and a few tiles high, the finished bands are written
+// into the file right away so only two bands (the one being written and the next one being rendered) are ever
+// in memory, the pixels are counted in 64 bits everywhere
+//
+
+// writes an image from the top to the bottom a few rows at a time
+
+class image_writer
+{
+public:
+	virtual ~image_writer() = default;
+
+	// count rows of RGBA pixels, one row after another
+	virtual bool write_rows(const sf::Uint8* rgba, uint count) = 0;
+	// has to be called after the last row
+	virtual bool finish() = 0;
+};
+
+// whether the file can be written band by band (.png, .tif, .tiff and .ppm)
+bool can_stream(const std::string& path);
+// nullptr when the extension isn't one of them or the file can't be created
+std::unique_ptr<image_writer> open_image_writer(const std::string& path, uint width, uint height);
+
+// memory the writer of an image of that width needs, the bands get the rest of band_memory
+size_t poster_writer_bytes(uint width);
+// memory a poster of that width takes with bands of that many rows, the writer included
+size_t poster_memory(uint width, uint rows);
+// 0 when not even one row of tiles fits into band_memory, the poster can't be rendered then
+uint poster_band_height(uint width, uint height, size_t band_memory);
+bool render_poster(util::ThreadPool& pool, const frame_params& frame, tile_cache* cache, image_writer& writer, size_t band_memory);
+
+#endif // FRACTAL_POSTER_HPP
@@ -0,0 +1,1109 @@
+#include "Fractal/Render.hpp"
+#include "Fractal/Formulas.hpp"
+
+#include <numeric>
+
+// function for reallocating the framebuffer after the size of the window changed
+// the frame being rendered is cancelled, the only waiting is for the rows the workers are in the middle of
+
+void framebuffer::resize(uint width_, uint height_)
+{
+	if (width_ == width && height_ == height)
+		return;
+
+	// the next frame can take over the pixels of the complete frame that are still in the window
+	bool keep;
+	{
+		std::lock_guard<std::mutex> lock(complete_mutex);
+		keep = complete_generation == generation;
+	}
+	cancel();
+	wait_idle();
+
+	previous_iterations.clear();
+	previous_last_z.clear();
+	if (keep)
+	{
+		std::swap(previous_iterations, iterations);
+		std::swap(previous_last_z, last_z);
+		std::lock_guard<std::mutex> lock(complete_mutex);
+		complete_generation = generation;
+	}
+
+	width = width_;
+	height = height_;
+	tiles_x = (width + tile_size - 1) / tile_size;
+	tiles_y = (height + tile_size - 1) / tile_size;
+
+	// counted in 64 bits, past a gigapixel the bytes of the pixels don't fit into 32
+	pixels.resize((size_t)tile_count() * tile_size * tile_size * 4);
+	iterations.resize((size_t)tile_count() * tile_size * tile_size);
+	last_z.resize((size_t)tile_count() * tile_size * tile_size);
+	tile_mutexes = std::make_unique<std::mutex[]>(tile_count());
+
+	// every tile of the current frame is pushed once per pass, the cancelled frame can push as many
+	// before the ui thread gets to drain them, more frames cancelled between two drains can still overflow it
+	uint passes = 1;
+	for (uint step = coarsest_step; step > 1; step /= 2)
+		passes++;
+	finished = std::make_unique<util::LockFreeQueue<finished_tile>>(2 * passes * tile_count() + 2 * std::thread::hardware_concurrency());
+	overflowed = false;
+
+	// the workers take their newest task first, so the tiles are queued from the edges of the window
+	// inwards and the middle of the screen, where the user is looking, is filled in first
+	tile_order.resize(tile_count());
+	std::iota(tile_order.begin(), tile_order.end(), 0);
+
+	auto distance = [this](uint tile) {
+		sf::IntRect rect = tile_rect(tile);
+		double dx = rect.left + rect.width / 2. - width / 2.;
+		double dy = rect.top + rect.height / 2. - height / 2.;
+		return dx * dx + dy * dy;
+	};
+	std::sort(tile_order.begin(), tile_order.end(), [&](uint a, uint b) {
+		return distance(a) > distance(b);
+	});
+}
+
+// stops all the frames that are being rendered
+
+void framebuffer::cancel()
+{
+	generation++;
+}
+
+void framebuffer::wait_idle()
+{
+	std::unique_lock<std::mutex> lock(idle_mutex);
+	idle.wait(lock, [this]() {
+		return busy == 0;
+	});
+}
+
+bool framebuffer::wait_done(const render_job& job, std::chrono::steady_clock::time_point until)
+{
+	std::unique_lock<std::mutex> lock(idle_mutex);
+	return idle.wait_until(lock, until, [&job]() {
+		return job.done();
+	});
+}
+
+// the count goes down under the lock, so the waiting threads can't miss the last task or return while it still notifies
+// (the job is counted done before, so wait_done() sees it once it gets the lock)
+
+void framebuffer::task_done(bool finished_job)
+{
+	std::lock_guard<std::mutex> lock(idle_mutex);
+	if (--busy == 0 || finished_job)
+		idle.notify_all();
+}
+
+uint framebuffer::tile_count() const
+{
+	return tiles_x * tiles_y;
+}
+
+// the part of the window covered by the tile, the tiles on the right and bottom edge can be smaller
+
+sf::IntRect framebuffer::tile_rect(uint tile) const
+{
+	uint x = (tile % tiles_x) * tile_size;
+	uint y = (tile / tiles_x) * tile_size;
+	uint tile_width = std::min(tile_size, width - x);
+	uint tile_height = std::min(tile_size, height - y);
+	return sf::IntRect(x, y, tile_width, tile_height);
+}
+
+// the pixels of the tile, rows are tile_rect(tile).width pixels long
+
+sf::Uint8* framebuffer::tile_pixels(uint tile)
+{
+	return &pixels[(size_t)tile * tile_size * tile_size * 4];
+}
+
+// the iterations of the pixels of the tile, laid out like tile_pixels()
+
+uint* framebuffer::tile_iterations(uint tile)
+{
+	return &iterations[(size_t)tile * tile_size * tile_size];
+}
+
+// the last z of the pixels of the tile, laid out like tile_pixels()
+
+complex* framebuffer::tile_last_z(uint tile)
+{
+	return &last_z[(size_t)tile * tile_size * tile_size];
+}
+
+std::mutex& framebuffer::tile_mutex(uint tile)
+{
+	return tile_mutexes[tile];
+}
+
+// a newer frame was started (or the window resized) after this one
+
+bool render_job::cancelled() const
+{
+	return generation != target->generation;
+}
+
+// true once none of the tiles of the job is queued or being rendered anymore
+
+bool render_job::done() const
+{
+	return remaining == 0;
+}
+
+// colours count samples of row y of the tile (sample i is pixel x_first + i * stride), stores their iterations
+// and last z and copies them into the tile as squares of block x block pixels, the coarse passes of progressive rendering use block > 1
+// returns false when a newer frame owns the tile by now
+
+static bool write_samples(render_job& job, uint tile, uint y, uint x_first, uint stride, uint count, const uint* iterations, const complex* last_z, uint block)
+{
+	framebuffer& target = *job.target;
+	sf::IntRect rect = target.tile_rect(tile);
+	sf::Uint8 colours[tile_size * 4];
+	colourise(iterations, last_z, count, *job.palette, colours);
+
+	// copying the samples into the framebuffer, unless a newer frame owns the tile by now
+	std::lock_guard<std::mutex> lock(target.tile_mutex(tile));
+	if (job.cancelled())
+		return false;
+
+	sf::Uint8* pixels = target.tile_pixels(tile);
+	uint* stored = target.tile_iterations(tile);
+	complex* stored_z = target.tile_last_z(tile);
+
+	if (stride == 1 && block == 1)
+	{
+		job.bytes_written += (4 + sizeof(uint) + sizeof(complex)) * count;
+		std::memcpy(pixels + 4 * (rect.width * y + x_first), colours, 4 * count);
+		std::memcpy(stored + rect.width * y + x_first, iterations, sizeof(uint) * count);
+		std::memcpy(stored_z + rect.width * y + x_first, last_z, sizeof(complex) * count);
+		return true;
+	}
+
+	uint rows = std::min(block, rect.height - y);
+	uint drawn = 0; // pixels of one scanline of the squares
+	for (uint i = 0; i < count; i++)
+	{
+		uint x = x_first + i * stride;
+		stored[rect.width * y + x] = iterations[i];
+		stored_z[rect.width * y + x] = last_z[i];
+		drawn += std::min(block, rect.width - x);
+	}
+	job.bytes_written += 4 * rows * drawn + (sizeof(uint) + sizeof(complex)) * count;
+
+	// the squares are drawn one scanline at a time so the writes go through the memory in order
+	for (uint r = 0; r < rows; r++)
+	{
+		sf::Uint8* row = pixels + 4 * rect.width * (y + r);
+		for (uint i = 0; i < count; i++)
+		{
+			uint x = x_first + i * stride;
+			uint square = std::min(block, rect.width - x);
+			for (uint c = 0; c < square; c++)
+				std::memcpy(row + 4 * (x + c), colours + 4 * i, 4);
+		}
+	}
+	return true;
+}
+
+// the grid of a frame centred in the middle of the window
+
+pixel_grid frame_grid(const frame_params& frame)
+{
+	pixel_grid grid;
+	grid.center.real = (frame.top_left.real + frame.bottom_right.real) / 2;
+	grid.center.imag = (frame.top_left.imag + frame.bottom_right.imag) / 2;
+	grid.delta.real = (frame.bottom_right.real - frame.top_left.real) / (int)frame.width;
+	grid.delta.imag = (frame.top_left.imag - frame.bottom_right.imag) / (int)frame.height;
+	grid.x_offset = -(int)frame.width / 2.;
+	grid.y_offset = -(int)frame.height / 2.;
+	return grid;
+}
+
+static double column_real(const pixel_grid& grid, uint x)
+{
+	return grid.center.real + (x + grid.x_offset) * grid.delta.real;
+}
+
+static double row_imag(const pixel_grid& grid, uint y)
+{
+	return grid.center.imag - (y + grid.y_offset) * grid.delta.imag;
+}
+
+// the iterations of one tile while it is being computed at full resolution
+
+struct subdivision
+{
+	const render_job* job;
+	row_kernel kernel;
+	row_job row;
+	pixel_grid grid;
+	sf::IntRect rect;
+	uint iterations[tile_size * tile_size]; // rows are tile_size long
+	complex last_z[tile_size * tile_size];
+	bool known[tile_size * tile_size];
+	uint computed = 0; // pixels the kernel was run for
+};
+
+// iterating the pixels x ... x + count - 1 of row y of the tile that aren't known yet
+
+static void evaluate(subdivision& s, uint x, uint y, uint count)
+{
+	uint* iterations = &s.iterations[y * tile_size];
+	bool* known = &s.known[y * tile_size];
+	s.row.imag = row_imag(s.grid, s.rect.top + y);
+
+	uint end = x + count;
+	while (x < end)
+	{
+		while (x < end && known[x])
+			x++;
+		uint begin = x;
+		while (x < end && !known[x])
+			x++;
+
+		if (begin < x)
+		{
+			s.row.x_begin = s.rect.left + begin + s.grid.x_offset;
+			s.row.count = x - begin;
+			s.row.last_z = &s.last_z[y * tile_size + begin];
+			s.kernel(s.row, iterations + begin);
+			s.computed += s.row.count;
+			std::fill(known + begin, known + x, true);
+		}
+	}
+}
+// mariani-silver subdivision of the rectangle of the tile with the corner x, y and size w, h
+// returns false when the job got cancelled
+
+static bool subdivide(subdivision& s, uint x, uint y, uint w, uint h)
+{
+	if (s.job->cancelled())
+		return false;
+
+	// small rectangles are iterated whole, splitting them further doesn't save anything
+	if (w <= 4 || h <= 4)
+	{
+		for (uint i = 0; i < h; i++)
+			evaluate(s, x, y + i, w);
+		return true;
+	}
+
+	uint half_w = w / 2;
+	uint half_h = h / 2;
+
+	// the border and the lines the rectangle would be split along (they are the borders of the parts anyway),
+	// checking the middle lines as well catches thin filaments that pass between the pixels of the border
+	evaluate(s, x, y, w);
+	evaluate(s, x, y + half_h, w);
+	evaluate(s, x, y + h - 1, w);
+	for (uint i = 1; i < h - 1; i++)
+	{
+		evaluate(s, x, y + i, 1);
+		evaluate(s, x + half_w, y + i, 1);
+		evaluate(s, x + w - 1, y + i, 1);
+	}
+
+	uint value = s.iterations[y * tile_size + x];
+	bool same = true;
+	for (uint i = 0; i < w && same; i++)
+	{
+		same = s.iterations[y * tile_size + x + i] == value
+			&& s.iterations[(y + half_h) * tile_size + x + i] == value
+			&& s.iterations[(y + h - 1) * tile_size + x + i] == value;
+	}
+	for (uint i = 1; i < h - 1 && same; i++)
+	{
+		same = s.iterations[(y + i) * tile_size + x] == value
+			&& s.iterations[(y + i) * tile_size + x + half_w] == value
+			&& s.iterations[(y + i) * tile_size + x + w - 1] == value;
+	}
+
+	if (same)
+	{
+		for (uint i = 1; i < h - 1; i++)
+		{
+			uint* row = &s.iterations[(y + i) * tile_size + x];
+			complex* last_z = &s.last_z[(y + i) * tile_size + x];
+			bool* known = &s.known[(y + i) * tile_size + x];
+			for (uint j = 1; j < w - 1; j++)
+			{
+				row[j] = value;
+				last_z[j] = unknown_z;
+				known[j] = true;
+			}
+		}
+		return true;
+	}
+
+	return subdivide(s, x, y, half_w, half_h)
+		&& subdivide(s, x + half_w, y, w - half_w, half_h)
+		&& subdivide(s, x, y + half_h, half_w, h - half_h)
+		&& subdivide(s, x + half_w, y + half_h, w - half_w, h - half_h);
+}
+
+// copying the iterations of the mirrored pixels of the tile from the tiles they are mirrored from
+// (they are finished, the tile was only queued after them)
+// the orbit of the mirrored mandelbrot pixel is the conjugate one, the orbits of the two julia pixels
+// are the same from z_1 on
+// returns the number of pixels copied
+
+static uint copy_mirrored(subdivision& s, framebuffer& target, uint tile)
+{
+	const render_job& job = *s.job;
+	uint copied = 0;
+	if (job.mirror_rows.empty())
+		return copied;
+
+	std::unique_lock<std::mutex> lock;
+	uint locked = (uint)-1;
+	const uint* source = nullptr;
+	const complex* source_z = nullptr;
+	uint source_left = 0;
+	uint source_width = 0;
+
+	for (uint y = 0; y < (uint)s.rect.height; y++)
+	{
+		int source_y = job.mirror_rows[s.rect.top + y];
+		if (source_y < 0 || source_y / tile_size >= tile / target.tiles_x)
+			continue;
+		uint source_top = source_y / tile_size * tile_size;
+
+		// mirrored about the real axis, the row is in the tile right above in the same columns
+		if (job.mirror_columns.empty())
+		{
+			uint source_tile = (source_y / tile_size) * target.tiles_x + tile % target.tiles_x;
+			if (source_tile != locked)
+			{
+				lock = std::unique_lock<std::mutex>(target.tile_mutex(source_tile));
+				locked = source_tile;
+			}
+			uint offset = (source_y - source_top) * s.rect.width;
+			std::memcpy(&s.iterations[y * tile_size], target.tile_iterations(source_tile) + offset, sizeof(uint) * s.rect.width);
+			const complex* z = target.tile_last_z(source_tile) + offset;
+			for (uint x = 0; x < (uint)s.rect.width; x++)
+				s.last_z[y * tile_size + x] = { z[x].real, -z[x].imag };
+			std::fill_n(&s.known[y * tile_size], s.rect.width, true);
+			copied += s.rect.width;
+			continue;
+		}
+
+		for (uint x = 0; x < (uint)s.rect.width; x++)
+		{
+			int source_x = job.mirror_columns[s.rect.left + x];
+			if (source_x < 0)
+				continue;
+
+			uint source_tile = (source_y / tile_size) * target.tiles_x + source_x / tile_size;
+			if (source_tile != locked)
+			{
+				lock = std::unique_lock<std::mutex>(target.tile_mutex(source_tile));
+				locked = source_tile;
+				source = target.tile_iterations(source_tile);
+				source_z = target.tile_last_z(source_tile);
+				source_left = source_x / tile_size * tile_size;
+				source_width = std::min(tile_size, target.width - source_left);
+			}
+			uint offset = (source_y - source_top) * source_width + source_x - source_left;
+			s.iterations[y * tile_size + x] = source[offset];
+			s.last_z[y * tile_size + x] = source_z[offset];
+			s.known[y * tile_size + x] = true;
+			copied++;
+		}
+	}
+	return copied;
+}
+
+// function generating the pixels of one tile of the job
+// kernel is one of the row kernels of the fractal, job.method decides how the pixels are iterated
+// only every step-th pixel in both directions is iterated and drawn as a step x step square,
+// in a progressive frame the samples of the previous pass (step * 2) are already in the framebuffer and are reused
+// the full resolution pass copies the pixels that are mirror images of the ones in the tiles above
+// a resumed job only continues the pixels that reached the max_iterations of the previous frame
+// returns false when the job got cancelled before the tile was finished
+
+bool generate(render_job& job, uint tile, row_kernel kernel, uint step)
+{
+	const frame_params& frame = job.frame;
+	sf::IntRect rect = job.target->tile_rect(tile);
+	bool refining = frame.progressive && step < coarsest_step;
+	const pixel_grid& grid = job.grid;
+
+	// the pixels taken over from the previous frame are in the framebuffer already
+	sf::IntRect reused;
+	const uint spacing = job.reused_spacing;
+	if (job.reused.intersects(rect, reused) && spacing == 1 && reused.width == rect.width && reused.height == rect.height)
+		return !job.cancelled();
+
+	// the row kernel computes a whole row of the tile at once (several pixels per instruction)
+	// the positions are calculated from the indices of the pixels instead of adding up deltas
+	// so every tile gives the same result no matter which thread and in what order renders it
+	row_job row;
+	row.origin_real = grid.center.real;
+	row.step = grid.delta.real;
+	row.x_begin = rect.left + grid.x_offset;
+	row.count = rect.width;
+	row.max_iterations = frame.max_iterations;
+	row.point = frame.julia_param;
+	row.reference = job.reference.data();
+	row.reference_length = (uint)job.reference.size();
+
+	if (step == 1)
+	{
+		// the whole tile is computed first, then it is written row by row
+		std::unique_ptr<subdivision> s = std::make_unique<subdivision>();
+		s->job = &job;
+		s->kernel = kernel;
+		s->row = row;
+		s->grid = grid;
+		s->rect = rect;
+		std::fill_n(s->known, tile_size * tile_size, false);
+
+		if (refining || job.resume_from > 0)
+		{
+			// every second pixel was computed by the previous pass, or every pixel by the previous frame
+			uint spacing = refining ? 2 : 1;
+			std::lock_guard<std::mutex> lock(job.target->tile_mutex(tile));
+			const uint* stored = job.target->tile_iterations(tile);
+			const complex* stored_z = job.target->tile_last_z(tile);
+			uint seeds = ((rect.height + spacing - 1) / spacing) * ((rect.width + spacing - 1) / spacing);
+			job.bytes_read += (sizeof(uint) + sizeof(complex)) * seeds;
+			for (uint y = 0; y < (uint)rect.height; y += spacing)
+			{
+				for (uint x = 0; x < (uint)rect.width; x += spacing)
+				{
+					uint i = y * tile_size + x;
+					s->iterations[i] = stored[y * rect.width + x];
+					s->last_z[i] = stored_z[y * rect.width + x];
+					s->known[i] = true;
+
+					// the escaped pixels and the ones known to never escape stay as they are
+					if (job.resume_from > 0 && s->iterations[i] == job.resume_from)
+					{
+						if (std::isnan(s->last_z[i].real))
+							s->iterations[i] = frame.max_iterations;
+						else
+							s->known[i] = false;
+					}
+				}
+			}
+		}
+		if (reused.width > 0)
+		{
+			// a zoomed in frame has every second pixel from the corner of job.reused
+			uint first_x = reused.left + (spacing - (reused.left - job.reused.left) % spacing) % spacing - rect.left;
+			uint first_y = reused.top + (spacing - (reused.top - job.reused.top) % spacing) % spacing - rect.top;
+			std::lock_guard<std::mutex> lock(job.target->tile_mutex(tile));
+			const uint* stored = job.target->tile_iterations(tile);
+			const complex* stored_z = job.target->tile_last_z(tile);
+			for (uint y = first_y; y < (uint)(reused.top + reused.height - rect.top); y += spacing)
+			{
+				for (uint x = first_x; x < (uint)(reused.left + reused.width - rect.left); x += spacing)
+				{
+					job.bytes_read += sizeof(uint) + sizeof(complex);
+					s->iterations[y * tile_size + x] = stored[y * rect.width + x];
+					s->last_z[y * tile_size + x] = stored_z[y * rect.width + x];
+					s->known[y * tile_size + x] = true;
+				}
+			}
+		}
+		// the pixels rendered before by other frames on the same grid
+		uint from_cache = 0;
+		if (job.cached)
+			from_cache = job.target->cache->lookup(job.key, job.grid_left + rect.left, job.grid_top + rect.top, rect.width, rect.height, s->iterations, s->last_z, s->known, tile_size);
+		job.bytes_read += (sizeof(uint) + sizeof(complex)) * copy_mirrored(*s, *job.target, tile);
+		s->row.resume = job.resume_from > 0;
+
+		if (job.method == render_method::subdivision && !s->row.resume)
+		{
+			if (!subdivide(*s, 0, 0, rect.width, rect.height))
+				return false;
+		}
+		else
+		{
+			for (uint y = 0; y < (uint)rect.height; y++)
+			{
+				// a newer frame was requested, there is no point in finishing this one
+				if (job.cancelled())
+					return false;
+				evaluate(*s, 0, y, rect.width);
+			}
+		}
+
+		job.pixels_computed += s->computed;
+		if (job.cached && from_cache < (uint)(rect.width * rect.height))
+			job.target->cache->store(job.key, job.grid_left + rect.left, job.grid_top + rect.top, rect.width, rect.height, s->iterations, s->last_z, tile_size,
+				!job.frame.recurring);
+
+		for (uint y = 0; y < (uint)rect.height; y++)
+		{
+			// the whole row was taken over from the previous frame
+			if (spacing == 1 && reused.width == rect.width && (int)y >= reused.top - rect.top && (int)y < reused.top + reused.height - rect.top)
+				continue;
+			if (!write_samples(job, tile, y, 0, 1, rect.width, &s->iterations[y * tile_size], &s->last_z[y * tile_size], 1))
+				return false;
+		}
+		return true;
+	}
+
+	uint iterations[tile_size];
+	complex last_z[tile_size];
+	row.last_z = last_z;
+
+	for (uint y = 0; y < (uint)rect.height; y += step)
+	{
+		// a newer frame was requested, there is no point in finishing this one
+		if (job.cancelled())
+			return false;
+
+		// in the rows of the previous pass only the samples between its samples are missing
+		uint first = 0;
+		row.stride = step;
+		if (refining && y % (2 * step) == 0)
+		{
+			first = step;
+			row.stride = 2 * step;
+		}
+		if (first >= (uint)rect.width)
+			continue;
+		row.x_begin = rect.left + first + grid.x_offset;
+		row.count = (rect.width - first + row.stride - 1) / row.stride;
+
+		row.imag = row_imag(grid, rect.top + y);
+		// getting the number of iterations it takes for the points of the row to escape
+		kernel(row, iterations);
+		job.pixels_computed += row.count;
+
+		if (!write_samples(job, tile, y, first, row.stride, row.count, iterations, last_z, step))
+			return false;
+	}
+	return true;
+}
+
+// finding the pixels of the frame that are exact mirror images of others
+// the mandelbrot set is symmetric about the real axis: the rows below the axis are copied from the rows above it
+// the julia sets are symmetric about 0: pixels below the axis are copied from the pixel on the other side of 0
+// only rows (columns) whose position is exactly the negative of another one are used, so copying gives the same result
+
+static void find_symmetry(render_job& job, bool point_symmetric)
+{
+	// a resumed frame has every pixel already
+	if (job.resume_from > 0)
+		return;
+
+	const frame_params& frame = job.frame;
+	const pixel_grid& grid = job.grid;
+
+	job.mirror_rows.assign(frame.height, -1);
+	double k = std::round(2 * (grid.center.imag / grid.delta.imag - grid.y_offset));
+	for (uint y = 0; y < frame.height; y++)
+	{
+		double other = k - y;
+		if (row_imag(grid, y) < 0 && other >= 0 && other < frame.height && row_imag(grid, (uint)other) == -row_imag(grid, y))
+			job.mirror_rows[y] = (int)other;
+	}
+
+	if (point_symmetric)
+	{
+		job.mirror_columns.assign(frame.width, -1);
+		double l = std::round(-2 * (grid.center.real / grid.delta.real + grid.x_offset));
+		for (uint x = 0; x < frame.width; x++)
+		{
+			double other = l - x;
+			if (other >= 0 && other < frame.width && column_real(grid, (uint)other) == -column_real(grid, x))
+				job.mirror_columns[x] = (int)other;
+		}
+	}
+
+	// the tiles the mirrored pixels of every tile are copied from, a tile is only queued after them
+	const framebuffer& target = *job.target;
+	job.copied_by.assign(target.tile_count(), std::vector<uint>());
+	job.copies_from = std::make_unique<std::atomic<uint>[]>(target.tile_count());
+	for (uint tile = 0; tile < target.tile_count(); tile++)
+	{
+		job.copies_from[tile] = 0;
+		sf::IntRect rect = target.tile_rect(tile);
+
+		// rows and columns of the tiles the pixels of the tile are mirrored from
+		std::vector<uint> source_rows;
+		std::vector<uint> source_columns;
+		for (uint y = rect.top; y < (uint)(rect.top + rect.height); y++)
+		{
+			if (job.mirror_rows[y] >= 0 && std::find(source_rows.begin(), source_rows.end(), job.mirror_rows[y] / tile_size) == source_rows.end())
+				source_rows.push_back(job.mirror_rows[y] / tile_size);
+		}
+		if (job.mirror_columns.empty())
+		{
+			source_columns.push_back(rect.left / tile_size);
+		}
+		else
+		{
+			for (uint x = rect.left; x < (uint)(rect.left + rect.width); x++)
+			{
+				if (job.mirror_columns[x] >= 0 && std::find(source_columns.begin(), source_columns.end(), job.mirror_columns[x] / tile_size) == source_columns.end())
+					source_columns.push_back(job.mirror_columns[x] / tile_size);
+			}
+		}
+
+		for (uint row : source_rows)
+		{
+			if (row >= tile / target.tiles_x)
+				continue;
+			for (uint column : source_columns)
+			{
+				job.copied_by[row * target.tiles_x + column].push_back(tile);
+				job.copies_from[tile]++;
+			}
+		}
+	}
+}
+
+// the index of pixel (x, y) in the tile after tile layout of a framebuffer of the given size
+
+static size_t layout_index(uint width, uint x, uint y)
+{
+	uint tiles_x = (width + tile_size - 1) / tile_size;
+	uint tile_left = x / tile_size * tile_size;
+	uint tile_width = std::min(tile_size, width - tile_left);
+	size_t tile = (y / tile_size) * tiles_x + x / tile_size;
+	return tile * tile_size * tile_size + (y % tile_size) * tile_width + x - tile_left;
+}
+
+// how the pixels of a frame map to the pixels of the complete frame it takes over from
+// pixel x of the frame is pixel (x * up + shift_x) / down of the complete frame, when that is a whole number
+// up = down = 1 when the view was moved, up = 2 when it was zoomed out 2x, down = 2 when it was zoomed in 2x
+
+struct frame_mapping
+{
+	int up;
+	int down;
+	int shift_x;
+	int shift_y;
+};
+
+static int ceil_div(int a, int b)
+{
+	return a >= 0 ? (a + b - 1) / b : -(-a / b);
+}
+
+// the pixels first, first + down ... < end of a row (column) of size pixels that are in the old one of old_size pixels
+
+static void mapped_range(int size, int old_size, int up, int down, int shift, int& first, int& end)
+{
+	first = std::max(0, ceil_div(-shift, up));
+	end = std::min(size, ceil_div(old_size * down - shift, up));
+	while (first < end && (first * up + shift) % down != 0)
+		first++;
+}
+
+//  function moving the pixels of the complete frame to where they are in the frame of the job
+// the iterations and last z are copied and the pixels coloured with the palette of the job
+// a moved frame copies them a tile row at a time
+// returns the pixels of the job that were taken over, every job.reused_spacing-th one from the corner
+
+static sf::IntRect take_over(render_job& job, const frame_mapping& mapping)
+{
+	framebuffer& target = *job.target;
+	const uint old_width = target.complete_frame.width;
+	const uint old_height = target.complete_frame.height;
+
+	// the same window size, the pixels are moved out of the way first
+	if (target.previous_iterations.empty())
+	{
+		std::swap(target.previous_iterations, target.iterations);
+		std::swap(target.previous_last_z, target.last_z);
+		target.iterations.resize(target.previous_iterations.size());
+		target.last_z.resize(target.previous_last_z.size());
+	}
+
+	int left, right, top, bottom;
+	mapped_range(target.width, old_width, mapping.up, mapping.down, mapping.shift_x, left, right);
+	mapped_range(target.height, old_height, mapping.up, mapping.down, mapping.shift_y, top, bottom);
+	sf::IntRect shared(left, top, right - left, bottom - top);
+	job.reused_spacing = mapping.down;
+
+	uint taken = 0;
+	if (mapping.up == 1 && mapping.down == 1)
+	{
+		for (uint tile = 0; tile < target.tile_count(); tile++)
+		{
+			sf::IntRect rect = target.tile_rect(tile);
+			sf::IntRect part;
+			if (!shared.intersects(rect, part))
+				continue;
+
+			for (uint y = part.top; y < (uint)(part.top + part.height); y++)
+			{
+				uint x = part.left;
+				while (x < (uint)(part.left + part.width))
+				{
+					// the run ends at the end of the part or of the row of the old tile
+					uint old_x = x + mapping.shift_x;
+					uint run = std::min<uint>(part.left + part.width - x, tile_size - old_x % tile_size);
+					size_t from = layout_index(old_width, old_x, y + mapping.shift_y);
+					size_t to = (size_t)tile * tile_size * tile_size + (y - rect.top) * rect.width + x - rect.left;
+
+					std::memcpy(&target.iterations[to], &target.previous_iterations[from], sizeof(uint) * run);
+					std::memcpy(&target.last_z[to], &target.previous_last_z[from], sizeof(complex) * run);
+					colourise(&target.iterations[to], &target.last_z[to], run, *job.palette, &target.pixels[4 * to]);
+					x += run;
+					taken += run;
+				}
+			}
+		}
+	}
+	else
+	{
+		// zoomed, every second pixel of the old frame (zoomed out) or to every second pixel of the new one (zoomed in)
+		for (int y = shared.top; y < bottom; y += mapping.down)
+		{
+			for (int x = shared.left; x < right; x += mapping.down)
+			{
+				size_t from = layout_index(old_width, (x * mapping.up + mapping.shift_x) / mapping.down, (y * mapping.up + mapping.shift_y) / mapping.down);
+				size_t to = layout_index(target.width, x, y);
+				target.iterations[to] = target.previous_iterations[from];
+				target.last_z[to] = target.previous_last_z[from];
+				colourise(&target.iterations[to], &target.last_z[to], 1, *job.palette, &target.pixels[4 * to]);
+				taken++;
+			}
+		}
+	}
+	job.bytes_read += (sizeof(uint) + sizeof(complex)) * taken;
+	job.bytes_written += (4 + sizeof(uint) + sizeof(complex)) * taken;
+
+	target.previous_iterations.clear();
+	target.previous_last_z.clear();
+	return shared;
+}
+
+// remembering the frame of the job as complete, unless a newer frame was started meanwhile
+
+static void mark_complete(render_job& job)
+{
+	framebuffer& target = *job.target;
+	std::lock_guard<std::mutex> lock(target.complete_mutex);
+	if (job.cancelled())
+		return;
+	target.complete_frame = job.frame;
+	target.complete_grid = job.grid;
+	target.complete_generation = job.generation;
+}
+
+// queues one tile of the job on the thread pool
+// the last tile of a progressive pass to finish queues the next, finer pass
+// at full resolution the tiles mirrored from this one are queued once it is done
+
+static void queue_tiles(util::ThreadPool& pool, const std::shared_ptr<render_job>& job, row_kernel kernel, uint step);
+
+static void queue_tile(util::ThreadPool& pool, const std::shared_ptr<render_job>& job, row_kernel kernel, uint step, uint tile)
+{
+	pool.submit([job, tile, kernel, step, &pool]() {
+		framebuffer& buffer = *job->target;
+		if (generate(*job, tile, kernel, step) && !buffer.finished->push({ job->generation, tile }))
+			buffer.overflowed = true;
+
+		if (step == 1 && !job->copied_by.empty())
+		{
+			for (uint mirrored : job->copied_by[tile])
+			{
+				if (--job->copies_from[mirrored] == 0)
+					queue_tile(pool, job, kernel, step, mirrored);
+			}
+		}
+		if (--job->pass_remaining == 0 && step > 1 && !job->cancelled())
+			queue_tiles(pool, job, kernel, step / 2);
+
+		job->render_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - job->started).count();
+		bool last = --job->remaining == 0;
+		if (last)
+			mark_complete(*job);
+		buffer.task_done(last);
+	});
+}
+
+// queues one pass of all the tiles of the job on the thread pool
+
+static void queue_tiles(util::ThreadPool& pool, const std::shared_ptr<render_job>& job, row_kernel kernel, uint step)
+{
+	framebuffer& target = *job->target;
+	job->remaining += target.tile_count();
+	job->pass_remaining = target.tile_count();
+	target.busy += target.tile_count();
+
+	// the tiles that wait for others are picked before any tile is queued, a finished tile could queue them already
+	std::vector<uint> ready;
+	for (uint tile : target.tile_order)
+	{
+		if (step != 1 || job->copied_by.empty() || job->copies_from[tile] == 0)
+			ready.push_back(tile);
+	}
+	for (uint tile : ready)
+		queue_tile(pool, job, kernel, step, tile);
+}
+
+static void queue_tiles(util::ThreadPool& pool, const std::shared_ptr<render_job>& job, row_kernel kernel)
+{
+	queue_tiles(pool, job, kernel, job->frame.progressive ? coarsest_step : 1);
+}
+
+// hash of a high precision number, the limbs past the last one that isn't 0 don't change it
+
+static ullong big_hash(const big_fixed& a)
+{
+	size_t length = a.limbs.size();
+	while (length > 1 && a.limbs[length - 1] == 0)
+		length--;
+
+	ullong hash = a.negative;
+	for (size_t i = 0; i < length; i++)
+		hash = hash_combine(hash, a.limbs[i]);
+	return hash;
+}
+
+// the grid of the frame in the tile cache of the target, a frame the cache has every pixel of skips the coarse passes
+// the julia parameter only tells the frames apart for the julia fractals
+// the pixels of a deep zoom frame are relative to the high precision centre of the view, it is part of the grid
+
+static void cache_frame(render_job& job, bool julia)
+{
+	tile_cache* cache = job.target->cache;
+	const pixel_grid& grid = job.grid;
+	if (cache == nullptr)
+		return;
+
+	double left = std::floor(grid.x_offset);
+	double top = std::floor(grid.y_offset);
+	job.key.which_one = job.frame.which_one;
+	job.key.max_iterations = job.frame.max_iterations;
+	job.key.julia_param = julia ? job.frame.julia_param : complex { 0, 0 };
+	job.key.center = grid.center;
+	job.key.delta = grid.delta;
+	job.key.phase = { grid.x_offset - left, grid.y_offset - top };
+	job.grid_left = (llong)left;
+	job.grid_top = (llong)top;
+	job.key.reference = 0;
+	if (job.frame.deep)
+		job.key.reference = hash_combine(big_hash(job.frame.view.center_real), big_hash(job.frame.view.center_imag));
+	job.cached = true;
+
+	if (job.frame.progressive && cache->covers(job.key, job.grid_left, job.grid_top, job.frame.width, job.frame.height))
+		job.frame.progressive = false;
+}
+
+// picking everything that depends on the fractal for the job, returns its row kernel
+
+typedef row_kernel (*fractal_setup)(render_job& job);
+
+template <class formula>
+static row_kernel setup_fractal(render_job& job)
+{
+	if (formula::connected(job.frame.julia_param, job.frame.max_iterations))
+		job.method = render_method::subdivision;
+	if (formula::mirror != symmetry::none)
+		find_symmetry(job, formula::mirror == symmetry::origin);
+	cache_frame(job, formula::julia);
+
+	// the fastest instruction set of this processor is picked on the first call
+	return best_row_kernels().*formula::kernel;
+}
+
+// the pixels of the last complete frame can be continued when the new frame only has a higher max_iterations
+// (deep zoom frames are always rendered from scratch, their reference orbit changes with max_iterations)
+
+static uint resumable_iterations(framebuffer& target, const frame_params& frame)
+{
+	std::lock_guard<std::mutex> lock(target.complete_mutex);
+	const frame_params& old = target.complete_frame;
+	if (target.complete_generation != target.generation || frame.deep || old.deep)
+		return 0;
+
+	bool same = frame.which_one == old.which_one && frame.width == old.width && frame.height == old.height
+		&& frame.top_left.real == old.top_left.real && frame.top_left.imag == old.top_left.imag
+		&& frame.bottom_right.real == old.bottom_right.real && frame.bottom_right.imag == old.bottom_right.imag
+		&& frame.julia_param.real == old.julia_param.real && frame.julia_param.imag == old.julia_param.imag;
+	return same && frame.max_iterations > old.max_iterations ? old.max_iterations : 0;
+}
+
+//  the frame can take over pixels of the last complete frame when it shows the same fractal with the same pixel size
+// moved by whole pixels (or with the window resized), or with the pixels 2x bigger or smaller and aligned to the old ones
+// the grid of the job is then the grid of the complete frame with the offsets moved (and the pixel size scaled by 2),
+// so the pixels it shares with it are exactly the same points
+
+static bool moved_frame(render_job& job, frame_mapping& mapping)
+{
+	framebuffer& target = *job.target;
+	const frame_params& frame = job.frame;
+	std::lock_guard<std::mutex> lock(target.complete_mutex);
+	const frame_params& old = target.complete_frame;
+	const pixel_grid& old_grid = target.complete_grid;
+	if (target.complete_generation != target.generation || frame.deep || old.deep)
+		return false;
+
+	bool same = frame.which_one == old.which_one && frame.max_iterations == old.max_iterations
+		&& frame.julia_param.real == old.julia_param.real && frame.julia_param.imag == old.julia_param.imag;
+	if (!same)
+		return false;
+
+	// the new pixels are the same size as the old ones, 2x bigger or 2x smaller
+	const frame_mapping scales[3] = { { 1, 1, 0, 0 }, { 2, 1, 0, 0 }, { 1, 2, 0, 0 } };
+	double ratio_real = job.grid.delta.real / old_grid.delta.real;
+	double ratio_imag = job.grid.delta.imag / old_grid.delta.imag;
+	bool scaled = false;
+	for (const frame_mapping& scale : scales)
+	{
+		double ratio = (double)scale.up / scale.down;
+		if (std::abs(ratio_real - ratio) <= 1e-9 * ratio && std::abs(ratio_imag - ratio) <= 1e-9 * ratio)
+		{
+			mapping = scale;
+			scaled = true;
+		}
+	}
+	if (!scaled)
+		return false;
+
+	// pixel x of the frame is pixel x * ratio + shift / down of the complete frame
+	double ratio = (double)mapping.up / mapping.down;
+	double x = ((job.grid.center.real - old_grid.center.real) / old_grid.delta.real + job.grid.x_offset * ratio - old_grid.x_offset) * mapping.down;
+	double y = ((old_grid.center.imag - job.grid.center.imag) / old_grid.delta.imag + job.grid.y_offset * ratio - old_grid.y_offset) * mapping.down;
+	if (std::abs(x - std::round(x)) > 1e-3 || std::abs(y - std::round(y)) > 1e-3 || std::abs(x) > 1e6 || std::abs(y) > 1e6)
+		return false;
+	mapping.shift_x = (int)std::round(x);
+	mapping.shift_y = (int)std::round(y);
+
+	int left, right, top, bottom;
+	mapped_range(frame.width, old.width, mapping.up, mapping.down, mapping.shift_x, left, right);
+	mapped_range(frame.height, old.height, mapping.up, mapping.down, mapping.shift_y, top, bottom);
+	if (left >= right || top >= bottom)
+		return false;
+
+	// multiplying and dividing by 2 is exact
+	job.grid = old_grid;
+	job.grid.delta.real *= ratio;
+	job.grid.delta.imag *= ratio;
+	job.grid.x_offset = (mapping.shift_x + old_grid.x_offset * mapping.down) / mapping.up;
+	job.grid.y_offset = (mapping.shift_y + old_grid.y_offset * mapping.down) / mapping.up;
+	return true;
+}
+
+// a function to deretminate which fractal to generate
+// it only queues the tiles on the thread pool and returns right away, the tiles show up in target.finished when they are done
+// the size of the frame has to match the size of the framebuffer
+
+std::shared_ptr<render_job> which(util::ThreadPool& pool, framebuffer& target, const frame_params& frame)
+{
+	// starting a new generation cancels the frames that are still being rendered
+	std::shared_ptr<render_job> job = std::make_shared<render_job>();
+	job->started = std::chrono::steady_clock::now();
+	job->frame = frame;
+	job->target = &target;
+	job->resume_from = resumable_iterations(target, frame);
+	job->grid = job->resume_from > 0 ? target.complete_grid : frame_grid(frame);
+	frame_mapping mapping { 1, 1, 0, 0 };
+	bool moved = job->resume_from == 0 && moved_frame(*job, mapping);
+	job->generation = ++target.generation;
+	job->palette = target.palettes.get(frame.colours, frame.max_iterations);
+	job->remaining = 0;
+
+	// deep zoom of the mandelbrot fractal, the reference orbit is calculated by the pool first
+	// and only then the tiles are queued, so the ui thread doesn't wait for it
+	if (frame.which_one == 0 && frame.deep)
+	{
+		// the positions of the pixels are relative to the reference point in the middle of the window
+		job->frame.top_left.real = -(int)frame.width / 2. * frame.view.pixel.real;
+		job->frame.top_left.imag = (int)frame.height / 2. * frame.view.pixel.imag;
+		job->frame.bottom_right.real = (int)frame.width / 2. * frame.view.pixel.real;
+		job->frame.bottom_right.imag = -(int)frame.height / 2. * frame.view.pixel.imag;
+		job->grid = frame_grid(job->frame);
+
+		job->method = render_method::subdivision;
+		job->remaining = 1;
+		target.busy++;
+		pool.submit([job, &pool]() {
+			framebuffer& buffer = *job->target;
+			if (!job->cancelled())
+			{
+				const deep_view& view = job->frame.view;
+				uint limbs = deep_precision(std::min(view.pixel.real, view.pixel.imag));
+				big_fixed real = view.center_real;
+				big_fixed imag = view.center_imag;
+				big_set_precision(real, std::max(limbs, big_precision(real)));
+				big_set_precision(imag, std::max(limbs, big_precision(imag)));
+
+				job->reference = reference_orbit(real, imag, job->frame.max_iterations);
+				cache_frame(*job, false);
+				queue_tiles(pool, job, perturbation_row);
+			}
+			buffer.task_done(--job->remaining == 0);
+		});
+		return job;
+	}
+
+	// the old pixels are already there, there is nothing to show coarse passes of
+	if (moved)
+	{
+		job->reused = take_over(*job, mapping);
+	}
+	else
+	{
+		target.previous_iterations.clear();
+		target.previous_last_z.clear();
+	}
+	if (job->resume_from > 0 || moved)
+		job->frame.progressive = false;
+
+	// the fractals in the order of which_one
+	static const fractal_setup fractals[] = {
+		setup_fractal<mandelbrot_formula>,
+		setup_fractal<mandelbrot_julia_formula>,
+		setup_fractal<burning_ship_formula>,
+		setup_fractal<burning_ship_julia_formula>
+	};
+	if (frame.which_one >= std::size(fractals))
+		return job;
+	row_kernel kernel = fractals[frame.which_one](*job);
+
+	queue_tiles(pool, job, kernel);
+	return job;
+}
+
+// colouring all the pixels of the framebuffer again from their iterations, without computing anything
+// max_iterations has to be the one of the frame in the framebuffer
+
+void recolour(framebuffer& target, const colouring& colours, uint max_iterations)
+{
+	std::shared_ptr<const palette_lut> palette = target.palettes.get(colours, max_iterations);
+	for (uint tile = 0; tile < target.tile_count(); tile++)
+	{
+		sf::IntRect rect = target.tile_rect(tile);
+		std::lock_guard<std::mutex> lock(target.tile_mutex(tile));
+		colourise(target.tile_iterations(tile), target.tile_last_z(tile), rect.width * rect.height, *palette, target.tile_pixels(tile));
+	}
+}
+
+// copying count rows of the framebuffer from row top on into rows, one row of RGBA pixels after another
+// (the way sf::Image and the image files keep them) instead of tile after tile
+
+void read_rows(framebuffer& target, uint top, uint count, sf::Uint8* rows)
+{
+	for (uint y = top; y < top + count; y++)
+	{
+		for (uint tile_x = 0; tile_x < target.tiles_x; tile_x++)
+		{
+			uint tile = (y / tile_size) * target.tiles_x + tile_x;
+			sf::IntRect rect = target.tile_rect(tile);
+			std::lock_guard<std::mutex> lock(target.tile_mutex(tile));
+			std::memcpy(rows + 4 * ((size_t)(y - top) * target.width + rect.left), target.tile_pixels(tile) + 4 * (y - rect.top) * rect.width, 4 * rect.width);
+		}
+	}
+}
+
+// thread pool used for rendering the fractals, it is created on the first use and sized to the number of cores
+
+util::ThreadPool& render_pool()
+{
+	static util::ThreadPool pool;
+	return pool;
+}
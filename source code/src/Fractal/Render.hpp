@@ -0,0 +1,198 @@
+#ifndef FRACTAL_RENDER_HPP
+#define FRACTAL_RENDER_HPP
+
+#include "Fractal/Colouring.hpp"
+#include "Fractal/DeepZoom.hpp"
+#include "Fractal/SimdKernels.hpp"
+#include "Fractal/TileCache.hpp"
+#include "Utility/LockFreeQueue.hpp"
+#include "Utility/ThreadPool.hpp"
+
+// side length of the square tiles the window is split into when rendering
+
+const uint tile_size = 64;
+
+// the first pass of a progressive frame iterates every 8th pixel in both directions, every next pass halves it
+
+const uint coarsest_step = 8;
+
+// everything that decides what a frame looks like
+
+struct frame_params
+{
+	uint which_one; // which fractal is being displayed
+	uint width;
+	uint height;
+	complex top_left;
+	complex bottom_right;
+	uint max_iterations;
+	complex julia_param;
+
+	// mandelbrot only: when deep is set the frame is rendered with perturbation around the centre of the view
+	bool deep = false;
+	deep_view view;
+
+	// show coarse passes (1/8, 1/4, 1/2 of the resolution) before the full one
+	bool progressive = false;
+
+	// the grid of the pixels can be met again later (see TileCache.hpp), otherwise its tiles are only cached as transient
+	bool recurring = true;
+
+	colouring colours;
+};
+
+// the positions of the pixels of a frame
+// pixel (x, y) lies at center + (x + x_offset) * delta.real - (y + y_offset) * delta.imag i
+// normally the offsets are minus half of the size of the frame, so the pixels the same number of rows (columns)
+// away from the middle have exactly opposite offsets, a frame that reuses the pixels of a moved one keeps
+// the grid of that frame and only moves the offsets by whole pixels, so the pixels keep exactly the same positions
+
+struct pixel_grid
+{
+	complex center;
+	complex delta; // "lengths" of one pixel
+	double x_offset;
+	double y_offset;
+};
+
+// a tile the thread pool finished for the frame with the given generation
+
+struct finished_tile
+{
+	uint generation;
+	uint tile;
+};
+
+class render_job;
+
+// the pixels of the window on the CPU side
+// it lives for the whole run of the program and is only reallocated by resize() when the size of the window changes
+// the pixels are stored tile after tile so every finished tile can be uploaded to the texture on its own
+
+class framebuffer
+{
+public:
+	uint width = 0;
+	uint height = 0;
+	uint tiles_x = 0;
+	uint tiles_y = 0;
+	std::vector<sf::Uint8> pixels; // RGBA ( red green blue alpha ) color model is used by sf::texture
+	std::vector<uint> iterations;  // the iterations the pixels were coloured from
+	std::vector<complex> last_z;   // z of the pixels after their last iteration (see Kernels.hpp)
+
+	// number of the newest frame, the tiles of the older frames stop as soon as it changes
+	std::atomic<uint> generation { 0 };
+	// tiles that are queued or being rendered, resize() waits for them before it frees the pixels
+	std::atomic<uint> busy { 0 };
+	// indices of the finished tiles handed to the ui thread
+	// resize() makes it big enough for every pass of two frames, a tile that still doesn't fit sets overflowed
+	// and the ui thread uploads all the tiles of the frame instead
+	std::unique_ptr<util::LockFreeQueue<finished_tile>> finished;
+	std::atomic<bool> overflowed { false };
+	// the order the tiles are queued in, from the edges of the window to the middle
+	std::vector<uint> tile_order;
+
+	// the last frame whose every tile was finished at full resolution (and nothing was drawn over since)
+	// when only max_iterations goes up the next frame continues its pixels instead of starting over
+	// a frame that only moves the view or changes the size of the window takes over the pixels it shares with it
+	std::mutex complete_mutex;
+	uint complete_generation = 0;
+	frame_params complete_frame {};
+	pixel_grid complete_grid {};
+	// the iterations and last z of the complete frame are moved here when the window is resized
+	std::vector<uint> previous_iterations;
+	std::vector<complex> previous_last_z;
+
+	// the tiles of the earlier frames, the frames look their pixels up there before computing them (none when null)
+	tile_cache* cache = nullptr;
+	// the palettes of the frames, built again only when the colours or max_iterations change
+	palette_cache palettes;
+
+	void resize(uint width_, uint height_);
+	void cancel();
+	// blocks until busy is 0, woken by the last task instead of checking it over and over
+	void wait_idle();
+	// blocks until the job of this framebuffer is done or the time comes, returns whether it is done
+	bool wait_done(const render_job& job, std::chrono::steady_clock::time_point until);
+	// a task of the thread pool is over, it mustn't touch the framebuffer after this
+	// finished_job - the task was the last one of its job
+	void task_done(bool finished_job);
+
+	uint tile_count() const;
+	sf::IntRect tile_rect(uint tile) const;
+	sf::Uint8* tile_pixels(uint tile);
+	uint* tile_iterations(uint tile);
+	complex* tile_last_z(uint tile);
+	std::mutex& tile_mutex(uint tile);
+
+private:
+	// a tile is written one row at a time under its mutex, so a cancelled frame can never overwrite a newer one
+	std::unique_ptr<std::mutex[]> tile_mutexes;
+	std::mutex idle_mutex;
+	std::condition_variable idle;
+};
+
+// ways of filling a tile with pixels
+// brute_force - every pixel is iterated
+// subdivision - mariani-silver: only the border of a rectangle is iterated, when all of it has the same number of
+//               iterations the inside is filled with it, otherwise the rectangle is split in 4 and each part is checked
+//               the same way, it is only exact for fractals whose areas of the same iterations are connected
+//               (and as long as nothing in them is thinner than a pixel)
+
+enum class render_method
+{
+	brute_force,
+	subdivision
+};
+
+// one frame rendered in the background by the thread pool
+
+class render_job
+{
+public:
+	frame_params frame;
+	framebuffer* target;
+	uint generation;
+	std::atomic<uint> remaining;
+	std::atomic<uint> pass_remaining; // tiles of the current pass of a progressive frame
+	render_method method = render_method::brute_force;
+
+	// symmetry of the frame, pixels that are exact mirror images of pixels in the tiles above are copied from them
+	std::vector<int> mirror_rows;					  // row with the opposite imaginary part, -1 when not mirrored
+	std::vector<int> mirror_columns;				  // julia only: column with the opposite real part
+	std::vector<std::vector<uint>> copied_by;		  // tiles that copy pixels from the tile
+	std::unique_ptr<std::atomic<uint>[]> copies_from; // unfinished tiles the tile copies pixels from
+	std::vector<complex> reference;				// reference orbit of a deep zoom frame
+	std::shared_ptr<const palette_lut> palette; // colours of the frame for every number of iterations, shared with the next frames
+
+	// bytes of the framebuffer the tiles of the job read and wrote (pixels, iterations and last z),
+	// counted per row so the memory traffic of a frame can be reported
+	std::atomic<ullong> bytes_read { 0 };
+	std::atomic<ullong> bytes_written { 0 };
+	std::atomic<ullong> pixels_computed { 0 }; // pixels the row kernels were run for
+	uint resume_from = 0;			// max_iterations of the frame whose pixels are continued, 0 when starting over
+	pixel_grid grid;				// positions of the pixels
+	sf::IntRect reused;				// pixels taken over from the previous frame (moved or zoomed 2x), empty when none
+	uint reused_spacing = 1;		// zoomed in: only every second pixel of reused in both directions is taken over
+	bool cached = false;			// whether the pixels are looked up in and added to the cache of the target
+	cache_key key;					// the grid of the frame in the cache
+	llong grid_left = 0;			// pixel 0, 0 of the frame on that grid
+	llong grid_top = 0;
+
+	// when which() started the frame and the seconds from then to its last tile, every tile sets them before it
+	// counts itself done, so once done() is true they hold the time the frame took
+	std::chrono::steady_clock::time_point started;
+	std::atomic<double> render_seconds { 0 };
+
+	bool cancelled() const;
+	bool done() const;
+};
+
+pixel_grid frame_grid(const frame_params& frame);
+bool generate(render_job& job, uint tile, row_kernel kernel, uint step = 1);
+std::shared_ptr<render_job> which(util::ThreadPool& pool, framebuffer& target, const frame_params& frame);
+void recolour(framebuffer& target, const colouring& colours, uint max_iterations);
+void read_rows(framebuffer& target, uint top, uint count, sf::Uint8* rows);
+util::ThreadPool& render_pool();
+
+#endif // FRACTAL_RENDER_HPP
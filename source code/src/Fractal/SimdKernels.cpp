@@ -0,0 +1,420 @@
+#include "Fractal/SimdKernels.hpp"
+#include "Fractal/Formulas.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define FRACTAL_SIMD_X86
+	#include <immintrin.h>
+#endif
+
+//
+//  every kernel below is a template over the fractal formula (see Formulas.hpp), the formula is
+// resolved at compile time so every instantiation is a straight loop without calls or branches on the fractal
+// the arithmetic is done in exactly the same order as in the scalar functions so the results match bit for bit
+// the cardioid/bulb test and the periodicity check of the scalar functions are done per lane as well
+//
+
+// scalar version, also used for the pixels at the end of a row that don't fill a whole vector
+// and for resuming the pixels, which are only a few scattered ones
+
+template <class formula>
+static void escape_row_scalar(const row_job& job, uint first, uint* iterations)
+{
+	for (uint i = first; i < job.count; i++)
+	{
+		complex pos;
+		pos.real = job.origin_real + (job.x_begin + i * job.stride) * job.step;
+		pos.imag = job.imag;
+		complex* last_z = job.last_z ? &job.last_z[i] : nullptr;
+
+		if (job.resume && !std::isinf(last_z->real))
+		{
+			if (!std::isnan(last_z->real))
+				iterations[i] = resume_iter(formula::julia ? job.point : pos, *last_z, iterations[i], job.max_iterations, formula::absolute);
+			else
+				iterations[i] = job.max_iterations;
+			continue;
+		}
+
+		iterations[i] = formula()(pos, job.max_iterations, job.point, last_z);
+	}
+}
+
+template <class formula>
+static void escape_row_plain(const row_job& job, uint* iterations)
+{
+	escape_row_scalar<formula>(job, 0, iterations);
+}
+
+#ifdef FRACTAL_SIMD_X86
+
+// SSE2 - 2 pixels at once, escaped lanes are frozen with and/andnot masks
+
+template <class formula>
+__attribute__((target("sse2"))) static void escape_row_sse2(const row_job& job, uint* iterations)
+{
+	if (job.resume)
+		return escape_row_scalar<formula>(job, 0, iterations);
+
+	const __m128d four = _mm_set1_pd(4.0);
+	const __m128d one = _mm_set1_pd(1.0);
+	const __m128d two = _mm_set1_pd(2.0);
+	const __m128d sign_bit = _mm_set1_pd(-0.0);
+	const __m128d lanes = _mm_mul_pd(_mm_set_pd(1.0, 0.0), _mm_set1_pd(job.stride));
+	const __m128d origin = _mm_set1_pd(job.origin_real);
+	const __m128d step = _mm_set1_pd(job.step);
+	const __m128d quarter = _mm_set1_pd(0.25);
+	const __m128d sixteenth = _mm_set1_pd(0.0625);
+	const __m128d max_count = _mm_set1_pd(job.max_iterations);
+	const __m128d nan = _mm_set1_pd(interior_z.real);
+
+	uint i = 0;
+	for (; i + 2 <= job.count; i += 2)
+	{
+		__m128d zr = _mm_add_pd(origin, _mm_mul_pd(_mm_add_pd(_mm_set1_pd(job.x_begin + i * job.stride), lanes), step));
+		__m128d zi = _mm_set1_pd(job.imag);
+		const __m128d cr = formula::julia ? _mm_set1_pd(job.point.real) : zr;
+		const __m128d ci = formula::julia ? _mm_set1_pd(job.point.imag) : zi;
+
+		__m128d sr = _mm_mul_pd(zr, zr);
+		__m128d si = _mm_mul_pd(zi, zi);
+		__m128d count = _mm_setzero_pd();
+		__m128d active = _mm_cmplt_pd(_mm_add_pd(sr, si), four);
+		__m128d interior = _mm_setzero_pd(); // lanes that never escape
+
+		if constexpr (formula::cardioid) // main cardioid and period 2 bulb
+		{
+			__m128d x = _mm_sub_pd(zr, quarter);
+			__m128d q = _mm_add_pd(_mm_mul_pd(x, x), si);
+			__m128d inside = _mm_cmplt_pd(_mm_mul_pd(q, _mm_add_pd(q, x)), _mm_mul_pd(quarter, si));
+			__m128d x_plus_one = _mm_add_pd(zr, one);
+			inside = _mm_or_pd(inside, _mm_cmplt_pd(_mm_add_pd(_mm_mul_pd(x_plus_one, x_plus_one), si), sixteenth));
+			count = _mm_and_pd(inside, max_count);
+			active = _mm_andnot_pd(inside, active);
+			interior = inside;
+		}
+
+		__m128d saved_r = zr;
+		__m128d saved_i = zi;
+		uint period = 1;
+		uint since_saved = 0;
+
+		for (uint n = 0; n < job.max_iterations && _mm_movemask_pd(active); n++)
+		{
+			__m128d cross;
+			if constexpr (formula::absolute) // |a| and |b| by clearing the sign bit
+			{
+				cross = _mm_mul_pd(_mm_mul_pd(two, _mm_andnot_pd(sign_bit, zr)), _mm_andnot_pd(sign_bit, zi));
+			}
+			else
+			{
+				__m128d xy = _mm_mul_pd(zr, zi);
+				cross = _mm_add_pd(xy, xy);
+			}
+			__m128d new_r = _mm_add_pd(_mm_sub_pd(sr, si), cr);
+			__m128d new_i = _mm_add_pd(cross, ci);
+
+			zr = _mm_or_pd(_mm_and_pd(active, new_r), _mm_andnot_pd(active, zr));
+			zi = _mm_or_pd(_mm_and_pd(active, new_i), _mm_andnot_pd(active, zi));
+			count = _mm_add_pd(count, _mm_and_pd(active, one));
+
+			// lanes that came back to the saved z are in a cycle
+			__m128d cycle = _mm_and_pd(active, _mm_and_pd(_mm_cmpeq_pd(zr, saved_r), _mm_cmpeq_pd(zi, saved_i)));
+			count = _mm_or_pd(_mm_and_pd(cycle, max_count), _mm_andnot_pd(cycle, count));
+			active = _mm_andnot_pd(cycle, active);
+			interior = _mm_or_pd(interior, cycle);
+			if (++since_saved == period)
+			{
+				saved_r = zr;
+				saved_i = zi;
+				since_saved = 0;
+				period *= 2;
+			}
+
+			sr = _mm_mul_pd(zr, zr);
+			si = _mm_mul_pd(zi, zi);
+			active = _mm_and_pd(active, _mm_cmplt_pd(_mm_add_pd(sr, si), four));
+		}
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(iterations + i), _mm_cvttpd_epi32(count));
+
+		if (job.last_z)
+		{
+			double real[2];
+			double imag[2];
+			_mm_storeu_pd(real, _mm_or_pd(_mm_and_pd(interior, nan), _mm_andnot_pd(interior, zr)));
+			_mm_storeu_pd(imag, _mm_or_pd(_mm_and_pd(interior, nan), _mm_andnot_pd(interior, zi)));
+			for (uint lane = 0; lane < 2; lane++)
+				job.last_z[i + lane] = { real[lane], imag[lane] };
+		}
+	}
+	escape_row_scalar<formula>(job, i, iterations);
+}
+
+// AVX2 - 4 pixels at once, escaped lanes are frozen with blendv
+
+template <class formula>
+__attribute__((target("avx2"))) static void escape_row_avx2(const row_job& job, uint* iterations)
+{
+	if (job.resume)
+		return escape_row_scalar<formula>(job, 0, iterations);
+
+	const __m256d four = _mm256_set1_pd(4.0);
+	const __m256d one = _mm256_set1_pd(1.0);
+	const __m256d two = _mm256_set1_pd(2.0);
+	const __m256d sign_bit = _mm256_set1_pd(-0.0);
+	const __m256d lanes = _mm256_mul_pd(_mm256_set_pd(3.0, 2.0, 1.0, 0.0), _mm256_set1_pd(job.stride));
+	const __m256d origin = _mm256_set1_pd(job.origin_real);
+	const __m256d step = _mm256_set1_pd(job.step);
+	const __m256d quarter = _mm256_set1_pd(0.25);
+	const __m256d sixteenth = _mm256_set1_pd(0.0625);
+	const __m256d max_count = _mm256_set1_pd(job.max_iterations);
+	const __m256d nan = _mm256_set1_pd(interior_z.real);
+
+	uint i = 0;
+	for (; i + 4 <= job.count; i += 4)
+	{
+		__m256d zr = _mm256_add_pd(origin, _mm256_mul_pd(_mm256_add_pd(_mm256_set1_pd(job.x_begin + i * job.stride), lanes), step));
+		__m256d zi = _mm256_set1_pd(job.imag);
+		const __m256d cr = formula::julia ? _mm256_set1_pd(job.point.real) : zr;
+		const __m256d ci = formula::julia ? _mm256_set1_pd(job.point.imag) : zi;
+
+		__m256d sr = _mm256_mul_pd(zr, zr);
+		__m256d si = _mm256_mul_pd(zi, zi);
+		__m256d count = _mm256_setzero_pd();
+		__m256d active = _mm256_cmp_pd(_mm256_add_pd(sr, si), four, _CMP_LT_OQ);
+		__m256d interior = _mm256_setzero_pd(); // lanes that never escape
+
+		if constexpr (formula::cardioid) // main cardioid and period 2 bulb
+		{
+			__m256d x = _mm256_sub_pd(zr, quarter);
+			__m256d q = _mm256_add_pd(_mm256_mul_pd(x, x), si);
+			__m256d inside = _mm256_cmp_pd(_mm256_mul_pd(q, _mm256_add_pd(q, x)), _mm256_mul_pd(quarter, si), _CMP_LT_OQ);
+			__m256d x_plus_one = _mm256_add_pd(zr, one);
+			inside = _mm256_or_pd(inside, _mm256_cmp_pd(_mm256_add_pd(_mm256_mul_pd(x_plus_one, x_plus_one), si), sixteenth, _CMP_LT_OQ));
+			count = _mm256_and_pd(inside, max_count);
+			active = _mm256_andnot_pd(inside, active);
+			interior = inside;
+		}
+
+		__m256d saved_r = zr;
+		__m256d saved_i = zi;
+		uint period = 1;
+		uint since_saved = 0;
+
+		for (uint n = 0; n < job.max_iterations && _mm256_movemask_pd(active); n++)
+		{
+			__m256d cross;
+			if constexpr (formula::absolute) // |a| and |b| by clearing the sign bit
+			{
+				cross = _mm256_mul_pd(_mm256_mul_pd(two, _mm256_andnot_pd(sign_bit, zr)), _mm256_andnot_pd(sign_bit, zi));
+			}
+			else
+			{
+				__m256d xy = _mm256_mul_pd(zr, zi);
+				cross = _mm256_add_pd(xy, xy);
+			}
+			__m256d new_r = _mm256_add_pd(_mm256_sub_pd(sr, si), cr);
+			__m256d new_i = _mm256_add_pd(cross, ci);
+
+			zr = _mm256_blendv_pd(zr, new_r, active);
+			zi = _mm256_blendv_pd(zi, new_i, active);
+			count = _mm256_add_pd(count, _mm256_and_pd(active, one));
+
+			// lanes that came back to the saved z are in a cycle
+			__m256d cycle = _mm256_and_pd(active, _mm256_and_pd(_mm256_cmp_pd(zr, saved_r, _CMP_EQ_OQ), _mm256_cmp_pd(zi, saved_i, _CMP_EQ_OQ)));
+			count = _mm256_blendv_pd(count, max_count, cycle);
+			active = _mm256_andnot_pd(cycle, active);
+			interior = _mm256_or_pd(interior, cycle);
+			if (++since_saved == period)
+			{
+				saved_r = zr;
+				saved_i = zi;
+				since_saved = 0;
+				period *= 2;
+			}
+
+			sr = _mm256_mul_pd(zr, zr);
+			si = _mm256_mul_pd(zi, zi);
+			active = _mm256_and_pd(active, _mm256_cmp_pd(_mm256_add_pd(sr, si), four, _CMP_LT_OQ));
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(iterations + i), _mm256_cvttpd_epi32(count));
+
+		if (job.last_z)
+		{
+			double real[4];
+			double imag[4];
+			_mm256_storeu_pd(real, _mm256_blendv_pd(zr, nan, interior));
+			_mm256_storeu_pd(imag, _mm256_blendv_pd(zi, nan, interior));
+			for (uint lane = 0; lane < 4; lane++)
+				job.last_z[i + lane] = { real[lane], imag[lane] };
+		}
+	}
+	escape_row_scalar<formula>(job, i, iterations);
+}
+
+// AVX-512 - 8 pixels at once, the lanes that are still iterating are kept in a mask register
+
+template <class formula>
+__attribute__((target("avx512f"))) static void escape_row_avx512(const row_job& job, uint* iterations)
+{
+	if (job.resume)
+		return escape_row_scalar<formula>(job, 0, iterations);
+
+	const __m512d four = _mm512_set1_pd(4.0);
+	const __m512d one = _mm512_set1_pd(1.0);
+	const __m512d two = _mm512_set1_pd(2.0);
+	const __m512i abs_mask = _mm512_set1_epi64(0x7fffffffffffffffLL);
+	const __m512d lanes = _mm512_mul_pd(_mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0), _mm512_set1_pd(job.stride));
+	const __m512d origin = _mm512_set1_pd(job.origin_real);
+	const __m512d step = _mm512_set1_pd(job.step);
+	const __m512d quarter = _mm512_set1_pd(0.25);
+	const __m512d sixteenth = _mm512_set1_pd(0.0625);
+	const __m512d max_count = _mm512_set1_pd(job.max_iterations);
+	const __m512d nan = _mm512_set1_pd(interior_z.real);
+
+	uint i = 0;
+	for (; i + 8 <= job.count; i += 8)
+	{
+		__m512d zr = _mm512_add_pd(origin, _mm512_mul_pd(_mm512_add_pd(_mm512_set1_pd(job.x_begin + i * job.stride), lanes), step));
+		__m512d zi = _mm512_set1_pd(job.imag);
+		const __m512d cr = formula::julia ? _mm512_set1_pd(job.point.real) : zr;
+		const __m512d ci = formula::julia ? _mm512_set1_pd(job.point.imag) : zi;
+
+		__m512d sr = _mm512_mul_pd(zr, zr);
+		__m512d si = _mm512_mul_pd(zi, zi);
+		__m512d count = _mm512_setzero_pd();
+		__mmask8 active = _mm512_cmp_pd_mask(_mm512_add_pd(sr, si), four, _CMP_LT_OQ);
+		__mmask8 interior = 0; // lanes that never escape
+
+		if constexpr (formula::cardioid) // main cardioid and period 2 bulb
+		{
+			__m512d x = _mm512_sub_pd(zr, quarter);
+			__m512d q = _mm512_add_pd(_mm512_mul_pd(x, x), si);
+			__mmask8 inside = _mm512_cmp_pd_mask(_mm512_mul_pd(q, _mm512_add_pd(q, x)), _mm512_mul_pd(quarter, si), _CMP_LT_OQ);
+			__m512d x_plus_one = _mm512_add_pd(zr, one);
+			inside |= _mm512_cmp_pd_mask(_mm512_add_pd(_mm512_mul_pd(x_plus_one, x_plus_one), si), sixteenth, _CMP_LT_OQ);
+			count = _mm512_mask_mov_pd(count, inside, max_count);
+			active &= ~inside;
+			interior = inside;
+		}
+
+		__m512d saved_r = zr;
+		__m512d saved_i = zi;
+		uint period = 1;
+		uint since_saved = 0;
+
+		for (uint n = 0; n < job.max_iterations && active; n++)
+		{
+			__m512d cross;
+			if constexpr (formula::absolute) // |a| and |b| by clearing the sign bit
+			{
+				__m512d abs_r = _mm512_castsi512_pd(_mm512_and_epi64(abs_mask, _mm512_castpd_si512(zr)));
+				__m512d abs_i = _mm512_castsi512_pd(_mm512_and_epi64(abs_mask, _mm512_castpd_si512(zi)));
+				cross = _mm512_mul_pd(_mm512_mul_pd(two, abs_r), abs_i);
+			}
+			else
+			{
+				__m512d xy = _mm512_mul_pd(zr, zi);
+				cross = _mm512_add_pd(xy, xy);
+			}
+			__m512d new_r = _mm512_add_pd(_mm512_sub_pd(sr, si), cr);
+			__m512d new_i = _mm512_add_pd(cross, ci);
+
+			zr = _mm512_mask_blend_pd(active, zr, new_r);
+			zi = _mm512_mask_blend_pd(active, zi, new_i);
+			count = _mm512_mask_add_pd(count, active, count, one);
+
+			// lanes that came back to the saved z are in a cycle
+			__mmask8 cycle = _mm512_mask_cmp_pd_mask(active, zr, saved_r, _CMP_EQ_OQ) & _mm512_mask_cmp_pd_mask(active, zi, saved_i, _CMP_EQ_OQ);
+			count = _mm512_mask_mov_pd(count, cycle, max_count);
+			active &= ~cycle;
+			interior |= cycle;
+			if (++since_saved == period)
+			{
+				saved_r = zr;
+				saved_i = zi;
+				since_saved = 0;
+				period *= 2;
+			}
+
+			sr = _mm512_mul_pd(zr, zr);
+			si = _mm512_mul_pd(zi, zi);
+			active = _mm512_mask_cmp_pd_mask(active, _mm512_add_pd(sr, si), four, _CMP_LT_OQ);
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(iterations + i), _mm512_maskz_cvttpd_epu32(0xff, count));
+
+		if (job.last_z)
+		{
+			double real[8];
+			double imag[8];
+			_mm512_storeu_pd(real, _mm512_mask_mov_pd(zr, interior, nan));
+			_mm512_storeu_pd(imag, _mm512_mask_mov_pd(zi, interior, nan));
+			for (uint lane = 0; lane < 8; lane++)
+				job.last_z[i + lane] = { real[lane], imag[lane] };
+		}
+	}
+	escape_row_scalar<formula>(job, i, iterations);
+}
+
+#endif // FRACTAL_SIMD_X86
+
+// asking the processor which instruction sets it supports
+
+simd_level detect_simd_level()
+{
+#ifdef FRACTAL_SIMD_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+		return simd_level::avx512;
+	if (__builtin_cpu_supports("avx2"))
+		return simd_level::avx2;
+	if (__builtin_cpu_supports("sse2"))
+		return simd_level::sse2;
+#endif
+	return simd_level::scalar;
+}
+
+const char* simd_level_name(simd_level level)
+{
+	switch (level)
+	{
+		case simd_level::sse2: return "SSE2";
+		case simd_level::avx2: return "AVX2";
+		case simd_level::avx512: return "AVX-512";
+		case simd_level::scalar:
+		default:
+			return "scalar";
+	}
+}
+
+// the kernel table for the given instruction set, falls back to scalar when it isn't compiled in
+
+const row_kernels& select_row_kernels(simd_level level)
+{
+	static const row_kernels scalar = { simd_level::scalar, escape_row_plain<mandelbrot_formula>, escape_row_plain<mandelbrot_julia_formula>, escape_row_plain<burning_ship_formula>, escape_row_plain<burning_ship_julia_formula> };
+#ifdef FRACTAL_SIMD_X86
+	static const row_kernels sse2 = { simd_level::sse2, escape_row_sse2<mandelbrot_formula>, escape_row_sse2<mandelbrot_julia_formula>, escape_row_sse2<burning_ship_formula>, escape_row_sse2<burning_ship_julia_formula> };
+	static const row_kernels avx2 = { simd_level::avx2, escape_row_avx2<mandelbrot_formula>, escape_row_avx2<mandelbrot_julia_formula>, escape_row_avx2<burning_ship_formula>, escape_row_avx2<burning_ship_julia_formula> };
+	static const row_kernels avx512 = { simd_level::avx512, escape_row_avx512<mandelbrot_formula>, escape_row_avx512<mandelbrot_julia_formula>, escape_row_avx512<burning_ship_formula>, escape_row_avx512<burning_ship_julia_formula> };
+
+	switch (level)
+	{
+		case simd_level::sse2: return sse2;
+		case simd_level::avx2: return avx2;
+		case simd_level::avx512: return avx512;
+		case simd_level::scalar:
+		default:
+			break;
+	}
+#else
+	UNUSED(level);
+#endif
+	return scalar;
+}
+
+// the fastest kernels this processor can run, picked once on the first call
+
+const row_kernels& best_row_kernels()
+{
+	static const row_kernels& best = select_row_kernels(detect_simd_level());
+	return best;
+}
@@ -0,0 +1,62 @@
+#ifndef FRACTAL_SIMD_KERNELS_HPP
+#define FRACTAL_SIMD_KERNELS_HPP
+
+#include "Fractal/Complex.hpp"
+
+// instruction sets the row kernels are compiled for, from the slowest to the fastest
+
+enum class simd_level
+{
+	scalar,
+	sse2,
+	avx2,
+	avx512
+};
+
+// a run of pixels in one row of the window, pixel i of the job is x = x_begin + i * stride
+// pixel x lies at origin_real + x * step (x can be negative and half), the same formula the scalar code uses,
+// so every instruction set gives bit-identical results
+
+struct row_job
+{
+	double origin_real;
+	double step;
+	double imag;
+	double x_begin;
+	uint count;
+	uint stride = 1; // every stride-th pixel, used by the coarse passes of progressive rendering
+	uint max_iterations;
+	complex point; // julia parameter, ignored by the non julia fractals
+
+	// deep zoom only: the orbit of the reference point the positions are relative to
+	const complex* reference;
+	uint reference_length;
+
+	// when set the last z of every pixel is written there (see Kernels.hpp)
+	complex* last_z = nullptr;
+	// continue the pixels from the iterations and last_z already in the output instead of starting over
+	// (pixels with unknown_z start over), used after max_iterations was raised
+	bool resume = false;
+};
+
+// writes the number of iterations of the count pixels of the job into iterations
+
+typedef void (*row_kernel)(const row_job& job, uint* iterations);
+
+// row kernels of all the fractals for one instruction set
+
+struct row_kernels
+{
+	simd_level level;
+	row_kernel mandelbrot;
+	row_kernel mandelbrot_julia;
+	row_kernel burning_ship;
+	row_kernel burning_ship_julia;
+};
+
+simd_level detect_simd_level();
+const char* simd_level_name(simd_level level);
+const row_kernels& select_row_kernels(simd_level level);
+const row_kernels& best_row_kernels();
+
+#endif // FRACTAL_SIMD_KERNELS_HPP
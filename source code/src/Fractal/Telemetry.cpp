@@ -0,0 +1,94 @@
+#include "Fractal/Telemetry.hpp"
+
+double frame_stats::megapixels_per_second() const
+{
+	return render_seconds > 0 ? (double)width * height / render_seconds / 1e6 : 0;
+}
+
+double frame_stats::at_max_fraction() const
+{
+	return width * height > 0 ? (double)at_max / ((double)width * height) : 0;
+}
+
+double frame_stats::bytes_per_pixel() const
+{
+	return width * height > 0 ? (double)(bytes_read + bytes_written + bytes_uploaded) / ((double)width * height) : 0;
+}
+
+void finish_stats(frame_stats& stats, const render_job& job)
+{
+	const frame_params& frame = job.frame;
+	stats.which_one = frame.which_one;
+	stats.width = frame.width;
+	stats.height = frame.height;
+	stats.max_iterations = frame.max_iterations;
+	stats.deep = frame.deep;
+	stats.render_seconds = job.render_seconds;
+	stats.pixels_computed = job.pixels_computed;
+	stats.bytes_read = job.bytes_read;
+	stats.bytes_written = job.bytes_written;
+
+	if (const tile_cache* cache = job.target->cache)
+	{
+		stats.cache_tiles = cache->tile_count();
+		stats.cache_bytes = cache->size();
+		stats.cache_hits = cache->hits;
+		stats.cache_disk_hits = cache->disk_hits;
+		stats.cache_misses = cache->misses;
+	}
+
+	// the framebuffer is read after the last tile, nothing writes into it anymore
+	stats.iterations = 0;
+	stats.at_max = 0;
+	for (uint count : job.target->iterations)
+	{
+		stats.iterations += count;
+		stats.at_max += count >= frame.max_iterations;
+	}
+}
+
+std::string stats_text(const frame_stats& stats, bool rendering, double last_draw_seconds)
+{
+	const double megabytes = 1024 * 1024;
+	std::stringstream text;
+	text << std::fixed << std::setprecision(1);
+	text << "Frame " << stats.number << (rendering ? " (rendering the next one)" : "") << '\n'
+		 << "Render: " << stats.render_seconds * 1000 << " ms, " << stats.megapixels_per_second() << " Mpixels/s\n"
+		 << "Iterations: " << stats.iterations / 1e6 << " M, " << stats.at_max_fraction() * 100 << "% at max\n"
+		 << "Computed: " << stats.pixels_computed / 1e6 << " Mpixels\n"
+		 << "Upload: " << stats.upload_seconds * 1000 << " ms\n"
+		 << "Draw: " << last_draw_seconds * 1000 << " ms\n"
+		 << "Memory: " << stats.bytes_written / megabytes << " MB written, " << stats.bytes_read / megabytes << " MB read\n"
+		 << "Uploaded: " << stats.bytes_uploaded / megabytes << " MB, " << stats.bytes_per_pixel() << " bytes/pixel\n"
+		 << "Tile cache: " << stats.cache_tiles << " tiles, " << stats.cache_bytes / megabytes << " MB\n"
+		 << "Cache hits: " << stats.cache_hits << " (" << stats.cache_disk_hits << " disk), " << stats.cache_misses << " misses";
+	return text.str();
+}
+
+bool telemetry_log::open(const std::string& path)
+{
+	file.open(path, std::ios::trunc);
+	file << "frame,fractal,width,height,max_iterations,deep,render_ms,mpixels_per_s,pixels_computed,iterations,"
+			"at_max_fraction,upload_ms,draw_ms,window_frames,bytes_read,bytes_written,bytes_uploaded,cache_tiles,cache_bytes,"
+			"cache_hits,cache_disk_hits,cache_misses\n";
+	return (bool)file;
+}
+
+bool telemetry_log::is_open() const
+{
+	return file.is_open();
+}
+
+// every line is flushed right away, a session that crashes keeps its frames
+
+void telemetry_log::write(const frame_stats& stats)
+{
+	if (!file.is_open())
+		return;
+	file << stats.number << ',' << stats.which_one << ',' << stats.width << ',' << stats.height << ',' << stats.max_iterations << ','
+		 << stats.deep << ',' << stats.render_seconds * 1000 << ',' << stats.megapixels_per_second() << ',' << stats.pixels_computed
+		 << ',' << stats.iterations << ',' << stats.at_max_fraction() << ',' << stats.upload_seconds * 1000 << ','
+		 << stats.draw_seconds * 1000 << ',' << stats.window_frames << ',' << stats.bytes_read << ',' << stats.bytes_written << ','
+		 << stats.bytes_uploaded << ',' << stats.cache_tiles << ',' << stats.cache_bytes << ',' << stats.cache_hits << ','
+		 << stats.cache_disk_hits << ',' << stats.cache_misses << std::endl;
+}
@@ -0,0 +1,64 @@
+#ifndef FRACTAL_TELEMETRY_HPP
+#define FRACTAL_TELEMETRY_HPP
+
+#include "Fractal/Render.hpp"
+
+//
+//  what the frames of the window cost, shown in the corner of the window (F3) and written into a csv file
+// (explorer --telemetry frames.csv), one line for every frame that was rendered to the end
+// render time is from which() to the last tile (timed by the tile itself), upload time is spent copying the tiles into the texture and
+// draw time drawing and displaying the window while the frame was being rendered
+//
+
+struct frame_stats
+{
+	uint number = 0; // frames rendered since the start of the program
+	uint which_one = 0;
+	uint width = 0;
+	uint height = 0;
+	uint max_iterations = 0;
+	bool deep = false;
+
+	double render_seconds = 0;
+	ullong pixels_computed = 0; // pixels the kernels were run for, the rest came from the cache, mirroring, the last frame ...
+	ullong iterations = 0;		// of all the pixels of the frame
+	ullong at_max = 0;			// pixels that reached max_iterations
+	double upload_seconds = 0;
+	double draw_seconds = 0;
+	uint window_frames = 0; // the window was drawn that many times
+
+	// memory traffic of the frame, the framebuffer read and written by the tiles and copied into the texture
+	ullong bytes_read = 0;
+	ullong bytes_written = 0;
+	ullong bytes_uploaded = 0;
+	// the tile cache of the framebuffer after the frame, zero without one
+	ullong cache_tiles = 0;
+	ullong cache_bytes = 0;
+	ullong cache_hits = 0;
+	ullong cache_disk_hits = 0;
+	ullong cache_misses = 0;
+
+	double megapixels_per_second() const;
+	double at_max_fraction() const;
+	double bytes_per_pixel() const;
+};
+
+// the parameters of the frame and the counters of the finished job and the tile cache,
+// the iterations are added up from the framebuffer
+void finish_stats(frame_stats& stats, const render_job& job);
+// the lines of the overlay, rendering is set while the next frame isn't done yet
+std::string stats_text(const frame_stats& stats, bool rendering, double last_draw_seconds);
+
+class telemetry_log
+{
+public:
+	// the header of the columns is written right away
+	bool open(const std::string& path);
+	bool is_open() const;
+	void write(const frame_stats& stats);
+
+private:
+	std::ofstream file;
+};
+
+#endif // FRACTAL_TELEMETRY_HPP
@@ -0,0 +1,611 @@
+#include "Fractal/TileCache.hpp"
+
+#include <cstring>
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+const uint tile_pixels = cache_tile_size * cache_tile_size;
+
+// memory one tile takes up, the pixels are most of it
+
+static const size_t tile_bytes = tile_pixels * (sizeof(uint) + sizeof(complex) + 1) + 128;
+
+// the bits of a double, so the keys are compared and hashed exactly
+
+static ullong bits(double value)
+{
+	ullong b;
+	std::memcpy(&b, &value, sizeof(b));
+	return b;
+}
+
+static bool same(complex a, complex b)
+{
+	return bits(a.real) == bits(b.real) && bits(a.imag) == bits(b.imag);
+}
+
+static bool same_key(const cache_key& a, const cache_key& b)
+{
+	return a.which_one == b.which_one && a.max_iterations == b.max_iterations && same(a.julia_param, b.julia_param)
+		&& same(a.center, b.center) && same(a.delta, b.delta) && same(a.phase, b.phase) && a.reference == b.reference;
+}
+
+bool operator==(const cache_address& a, const cache_address& b)
+{
+	return a.x == b.x && a.y == b.y && same_key(a.key, b.key);
+}
+
+// boost::hash_combine
+
+ullong hash_combine(ullong hash, ullong value)
+{
+	return hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+}
+
+// the same on every run of the program, the files of the tiles are named after it
+
+static ullong address_hash(const cache_address& address)
+{
+	const cache_key& key = address.key;
+	const ullong parts[] = { key.which_one, key.max_iterations, bits(key.julia_param.real), bits(key.julia_param.imag),
+		bits(key.center.real), bits(key.center.imag), bits(key.delta.real), bits(key.delta.imag), bits(key.phase.real),
+		bits(key.phase.imag), key.reference, (ullong)address.x, (ullong)address.y };
+
+	ullong hash = 0;
+	for (ullong part : parts)
+		hash = hash_combine(hash, part);
+	return hash;
+}
+
+size_t cache_address_hash::operator()(const cache_address& address) const
+{
+	return (size_t)address_hash(address);
+}
+
+// rounding down also for the negative pixels
+
+static llong floor_div(llong a, llong b)
+{
+	return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+//
+//  the files of the tiles
+// the header is followed by the iterations, the last z and whether the pixels are known (one byte each),
+// they are only read on the computer that wrote them, so everything is stored as it is in memory
+//
+
+static const char tile_magic[8] = "FRTILE1";
+
+struct tile_header
+{
+	char magic[8];
+	cache_address address;
+	uint known_count;
+};
+
+static const size_t tile_file_size = sizeof(tile_header) + tile_pixels * (sizeof(uint) + sizeof(complex) + 1);
+
+// a tile file mapped into memory for as long as the object lives
+
+class mapped_tile
+{
+public:
+	const tile_header* header = nullptr;
+	const uint* iterations = nullptr;
+	const complex* last_z = nullptr;
+	const uint8_t* known = nullptr;
+
+	explicit mapped_tile(const std::string& name)
+	{
+#ifdef _WIN32
+		// no mapping, the file is read into memory
+		std::ifstream file(name, std::ios::binary);
+		buffer.resize(tile_file_size / sizeof(ullong) + 1);
+		if (!file.read((char*)buffer.data(), tile_file_size) || file.gcount() != (std::streamsize)tile_file_size)
+			return;
+		data = buffer.data();
+#else
+		int file = open(name.c_str(), O_RDONLY);
+		if (file < 0)
+			return;
+		struct stat status;
+		if (fstat(file, &status) == 0 && (size_t)status.st_size == tile_file_size)
+		{
+			void* mapped = mmap(nullptr, tile_file_size, PROT_READ, MAP_PRIVATE, file, 0);
+			if (mapped != MAP_FAILED)
+				data = mapped;
+		}
+		close(file);
+		if (data == nullptr)
+			return;
+#endif
+		header = (const tile_header*)data;
+		iterations = (const uint*)((const char*)data + sizeof(tile_header));
+		last_z = (const complex*)(iterations + tile_pixels);
+		known = (const uint8_t*)(last_z + tile_pixels);
+	}
+
+	~mapped_tile()
+	{
+#ifndef _WIN32
+		if (data != nullptr)
+			munmap(data, tile_file_size);
+#endif
+	}
+
+	mapped_tile(const mapped_tile&) = delete;
+	mapped_tile& operator=(const mapped_tile&) = delete;
+
+	// whether the file is a tile with the address (and not a different one with the same hash)
+	bool holds(const cache_address& address) const
+	{
+		return header != nullptr && std::memcmp(header->magic, tile_magic, sizeof(tile_magic)) == 0 && header->address == address;
+	}
+
+private:
+	void* data = nullptr;
+#ifdef _WIN32
+	std::vector<ullong> buffer;
+#endif
+};
+
+//
+//  copying pixels between the tiles and the rectangles of lookup() and store()
+//
+
+// the part of the rectangle in the tile, in the pixels of the grid
+struct overlap
+{
+	llong tile_left;
+	llong tile_top;
+	llong x_begin;
+	llong x_end;
+	llong y_begin;
+	llong y_end;
+};
+
+static overlap tile_overlap(const cache_address& address, llong left, llong top, uint width, uint height)
+{
+	overlap o;
+	o.tile_left = address.x * cache_tile_size;
+	o.tile_top = address.y * cache_tile_size;
+	o.x_begin = std::max(left, o.tile_left);
+	o.x_end = std::min<llong>(left + width, o.tile_left + cache_tile_size);
+	o.y_begin = std::max(top, o.tile_top);
+	o.y_end = std::min<llong>(top + height, o.tile_top + cache_tile_size);
+	return o;
+}
+
+// copying the known pixels of the tile into the pixels of the rectangle that aren't known yet
+
+static uint copy_from_tile(const overlap& o, const uint* tile_iterations, const complex* tile_last_z, const uint8_t* tile_known,
+	llong left, llong top, uint* iterations, complex* last_z, bool* known, uint stride)
+{
+	uint copied = 0;
+	for (llong y = o.y_begin; y < o.y_end; y++)
+	{
+		for (llong x = o.x_begin; x < o.x_end; x++)
+		{
+			size_t from = (y - o.tile_top) * cache_tile_size + x - o.tile_left;
+			size_t to = (y - top) * stride + x - left;
+			if (known[to] || !tile_known[from])
+				continue;
+			iterations[to] = tile_iterations[from];
+			last_z[to] = tile_last_z[from];
+			known[to] = true;
+			copied++;
+		}
+	}
+	return copied;
+}
+
+static bool tile_covers(const overlap& o, const uint8_t* tile_known, uint known_count)
+{
+	if (known_count == tile_pixels)
+		return true;
+
+	for (llong y = o.y_begin; y < o.y_end; y++)
+	{
+		for (llong x = o.x_begin; x < o.x_end; x++)
+		{
+			if (!tile_known[(y - o.tile_top) * cache_tile_size + x - o.tile_left])
+				return false;
+		}
+	}
+	return true;
+}
+
+//
+//  the cache
+//
+
+tile_cache::tile_cache(size_t budget, size_t disk_budget) :
+	budget_bytes(budget),
+	disk_budget_bytes(disk_budget)
+{
+}
+
+tile_cache::~tile_cache()
+{
+	flush();
+}
+
+void tile_cache::set_budget(size_t budget)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	budget_bytes = budget;
+	evict();
+}
+
+size_t tile_cache::budget() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return budget_bytes;
+}
+
+size_t tile_cache::size() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return used();
+}
+
+size_t tile_cache::used() const
+{
+	return (tiles.size() + transient_tiles.size()) * tile_bytes;
+}
+
+size_t tile_cache::tile_count() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return tiles.size() + transient_tiles.size();
+}
+
+void tile_cache::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	index.clear();
+	tiles.clear();
+	transient_tiles.clear();
+}
+
+void tile_cache::set_directory(const std::string& directory_)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	directory = directory_;
+	if (directory.empty())
+		return;
+
+	std::error_code error;
+	util::fs::create_directories(directory, error);
+	if (!util::fs::is_directory(directory, error))
+	{
+		std::cerr << "The tile cache can't use the directory " << directory << std::endl;
+		directory.clear();
+		return;
+	}
+
+	// the files written by the earlier runs, the most recently used first
+	files.clear();
+	file_index.clear();
+	std::vector<std::pair<util::fs::file_time_type, ullong>> found;
+	for (const auto& entry : util::fs::directory_iterator(directory, error))
+	{
+		ullong hash;
+		std::istringstream name(entry.path().stem().string());
+		if (entry.path().extension() != ".tile" || !(name >> std::hex >> hash))
+			continue;
+		found.push_back({ util::fs::last_write_time(entry.path(), error), hash });
+	}
+	std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+	for (const auto& file : found)
+	{
+		files.push_back(file.second);
+		file_index[file.second] = std::prev(files.end());
+	}
+	evict_files();
+}
+
+void tile_cache::set_disk_budget(size_t budget)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	disk_budget_bytes = budget;
+	evict_files();
+}
+
+size_t tile_cache::disk_budget() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return disk_budget_bytes;
+}
+
+size_t tile_cache::disk_size() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return files.size() * tile_file_size;
+}
+
+// the least recently used tiles are written first so the files end up in the same order, the transient tiles are never written
+
+void tile_cache::flush()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto cached = tiles.rbegin(); cached != tiles.rend(); cached++)
+	{
+		if (cached->dirty)
+			write(*cached);
+	}
+}
+
+void tile_cache::persist(const cache_key& key)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (tile_list::iterator cached = transient_tiles.begin(); cached != transient_tiles.end();)
+	{
+		tile_list::iterator next = std::next(cached);
+		if (same_key(cached->address.key, key))
+		{
+			tiles.splice(tiles.begin(), transient_tiles, cached);
+			cached->transient = false;
+			cached->dirty = true;
+		}
+		cached = next;
+	}
+}
+
+std::string tile_cache::file_name(const cache_address& address) const
+{
+	return file_name(address_hash(address));
+}
+
+std::string tile_cache::file_name(ullong hash) const
+{
+	std::ostringstream name;
+	name << directory << '/' << std::hex << std::setw(16) << std::setfill('0') << hash << ".tile";
+	return name.str();
+}
+
+// the file moved to the front of the files, added when it is new
+
+void tile_cache::use_file(ullong hash)
+{
+	auto found = file_index.find(hash);
+	if (found != file_index.end())
+	{
+		files.splice(files.begin(), files, found->second);
+		return;
+	}
+	files.push_front(hash);
+	file_index[hash] = files.begin();
+}
+
+// deleting the least recently used files until the directory fits into its budget
+
+void tile_cache::evict_files()
+{
+	while (!files.empty() && files.size() * tile_file_size > disk_budget_bytes)
+	{
+		std::error_code error;
+		util::fs::remove(file_name(files.back()), error);
+		file_index.erase(files.back());
+		files.pop_back();
+	}
+}
+
+// writing the tile into a new file first, so a program reading the old one at the same time never sees half of it
+
+void tile_cache::write(tile& cached)
+{
+	cached.dirty = false;
+	if (directory.empty())
+		return;
+
+	tile_header header {};
+	std::memcpy(header.magic, tile_magic, sizeof(tile_magic));
+	header.address = cached.address;
+	header.known_count = cached.known_count;
+
+	std::string name = file_name(cached.address);
+	std::string temporary = name + ".new";
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		file.write((const char*)&header, sizeof(header));
+		file.write((const char*)cached.iterations.data(), sizeof(uint) * tile_pixels);
+		file.write((const char*)cached.last_z.data(), sizeof(complex) * tile_pixels);
+		file.write((const char*)cached.known.data(), tile_pixels);
+		if (!file)
+			return;
+	}
+	std::error_code error;
+	util::fs::rename(temporary, name, error);
+	if (error)
+		return;
+	use_file(address_hash(cached.address));
+	evict_files();
+}
+
+tile_cache::tile_list& tile_cache::list_of(const tile& cached)
+{
+	return cached.transient ? transient_tiles : tiles;
+}
+
+// the tile with the address moved to the front of its list, tiles.end() when it isn't cached
+
+tile_cache::tile_list::iterator tile_cache::find(const cache_address& address)
+{
+	auto found = index.find(address);
+	if (found == index.end())
+		return tiles.end();
+
+	tile_list& list = list_of(*found->second);
+	list.splice(list.begin(), list, found->second);
+	return found->second;
+}
+
+// dropping the least recently used tiles until the cache fits into the budget, the transient ones first,
+// the changed ones are written before they are dropped
+
+void tile_cache::evict()
+{
+	while (!transient_tiles.empty() && used() > budget_bytes)
+	{
+		index.erase(transient_tiles.back().address);
+		transient_tiles.pop_back();
+	}
+	while (!tiles.empty() && used() > budget_bytes)
+	{
+		if (tiles.back().dirty)
+			write(tiles.back());
+		index.erase(tiles.back().address);
+		tiles.pop_back();
+	}
+}
+
+uint tile_cache::lookup(const cache_key& key, llong left, llong top, uint width, uint height, uint* iterations, complex* last_z, bool* known, uint stride)
+{
+	uint copied = 0;
+	cache_address address { key, 0, 0 };
+
+	for (address.y = floor_div(top, cache_tile_size); address.y <= floor_div(top + height - 1, cache_tile_size); address.y++)
+	{
+		for (address.x = floor_div(left, cache_tile_size); address.x <= floor_div(left + width - 1, cache_tile_size); address.x++)
+		{
+			overlap o = tile_overlap(address, left, top, width, height);
+			std::string name;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				tile_list::iterator cached = find(address);
+				if (cached != tiles.end())
+				{
+					hits++;
+					copied += copy_from_tile(o, cached->iterations.data(), cached->last_z.data(), cached->known.data(), left, top, iterations, last_z, known, stride);
+					continue;
+				}
+				if (!directory.empty())
+					name = file_name(address);
+			}
+
+			// the files are only replaced as a whole, they can be read without the lock
+			if (!name.empty())
+			{
+				mapped_tile file(name);
+				if (file.holds(address))
+				{
+					disk_hits++;
+					copied += copy_from_tile(o, file.iterations, file.last_z, file.known, left, top, iterations, last_z, known, stride);
+
+					// the time of the file keeps the order of the files for the next runs
+					std::error_code error;
+					util::fs::last_write_time(name, util::fs::file_time_type::clock::now(), error);
+					std::lock_guard<std::mutex> lock(mutex);
+					use_file(address_hash(address));
+					continue;
+				}
+			}
+			misses++;
+		}
+	}
+	return copied;
+}
+
+bool tile_cache::covers(const cache_key& key, llong left, llong top, uint width, uint height)
+{
+	cache_address address { key, 0, 0 };
+
+	for (address.y = floor_div(top, cache_tile_size); address.y <= floor_div(top + height - 1, cache_tile_size); address.y++)
+	{
+		for (address.x = floor_div(left, cache_tile_size); address.x <= floor_div(left + width - 1, cache_tile_size); address.x++)
+		{
+			overlap o = tile_overlap(address, left, top, width, height);
+			std::string name;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				auto found = index.find(address);
+				if (found != index.end())
+				{
+					if (!tile_covers(o, found->second->known.data(), found->second->known_count))
+						return false;
+					continue;
+				}
+				if (directory.empty())
+					return false;
+				name = file_name(address);
+			}
+
+			mapped_tile file(name);
+			if (!file.holds(address) || !tile_covers(o, file.known, file.header->known_count))
+				return false;
+		}
+	}
+	return true;
+}
+
+void tile_cache::store(const cache_key& key, llong left, llong top, uint width, uint height, const uint* iterations, const complex* last_z, uint stride,
+	bool transient)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	cache_address address { key, 0, 0 };
+
+	for (address.y = floor_div(top, cache_tile_size); address.y <= floor_div(top + height - 1, cache_tile_size); address.y++)
+	{
+		for (address.x = floor_div(left, cache_tile_size); address.x <= floor_div(left + width - 1, cache_tile_size); address.x++)
+		{
+			tile_list::iterator cached = find(address);
+			if (cached == tiles.end())
+			{
+				tile_list& list = transient ? transient_tiles : tiles;
+				list.emplace_front();
+				cached = list.begin();
+				cached->address = address;
+				cached->transient = transient;
+				cached->iterations.resize(tile_pixels);
+				cached->last_z.resize(tile_pixels);
+				cached->known.resize(tile_pixels, 0);
+				index[address] = cached;
+
+				// the rest of the tile can be on the disk already, the file is written again with all of it
+				if (!directory.empty() && !transient)
+				{
+					mapped_tile file(file_name(address));
+					if (file.holds(address))
+					{
+						std::memcpy(cached->iterations.data(), file.iterations, sizeof(uint) * tile_pixels);
+						std::memcpy(cached->last_z.data(), file.last_z, sizeof(complex) * tile_pixels);
+						std::memcpy(cached->known.data(), file.known, tile_pixels);
+						cached->known_count = file.header->known_count;
+					}
+				}
+			}
+			else if (cached->transient && !transient)
+			{
+				// the grid turned out to come back after all
+				tiles.splice(tiles.begin(), transient_tiles, cached);
+				cached->transient = false;
+			}
+
+			overlap o = tile_overlap(address, left, top, width, height);
+			for (llong y = o.y_begin; y < o.y_end; y++)
+			{
+				for (llong x = o.x_begin; x < o.x_end; x++)
+				{
+					size_t to = (y - o.tile_top) * cache_tile_size + x - o.tile_left;
+					size_t from = (y - top) * stride + x - left;
+					cached->iterations[to] = iterations[from];
+					cached->last_z[to] = last_z[from];
+					if (!cached->known[to])
+					{
+						cached->known[to] = 1;
+						cached->known_count++;
+					}
+				}
+			}
+			cached->dirty = true;
+		}
+	}
+	evict();
+}
@@ -0,0 +1,132 @@
+#ifndef FRACTAL_TILE_CACHE_HPP
+#define FRACTAL_TILE_CACHE_HPP
+
+#include "Fractal/Complex.hpp"
+
+#include <unordered_map>
+
+// iterations of the parts of the fractals that were rendered before, so going back to them (the starting view,
+// zooming back out) doesn't compute them again
+// the tiles are squares of the pixels of one grid in fractal coordinates: the fractal, its parameters, the middle
+// of the grid and the size of its pixels (the zoom level) pick the grid, the tile index picks the square in it,
+// pixel (x, y) of the grid lies at center + (x + phase.real) * delta.real - (y + phase.imag) * delta.imag i
+// the frames that keep the grid of the frame they move or zoom from share their tiles with it
+// the grid is keyed by its exact centre and pixel size, so only the frames that come back to exactly the same grid
+// hit: panning within the grid, the starting view and the 2x grid zoom levels of it, deep zooms restored from the
+// session, a frame zoomed by an arbitrary factor (the mouse wheel) lands on a new grid that is never met again once
+// the view zooms away from it, its tiles are stored as transient: they only help panning back within it, they are
+// dropped before any other tile and never written to the disk
+// the least recently used tiles are dropped when the cache gets over its memory budget
+// with a directory set the tiles are also kept on the disk between the runs of the program, one file per tile
+// named after the hash of its address, the tiles that aren't in memory are looked up there (the files are mapped
+// into memory and the pixels copied straight out of them)
+// the tiles are written when they are evicted (by the thread storing the new ones) and by flush(), the directory has
+// a budget of its own, the files used least recently (by their modification time) are deleted when it is over it
+
+const uint cache_tile_size = 64;
+
+// the grid of a frame, only frames with exactly the same one share tiles
+
+struct cache_key
+{
+	uint which_one;
+	uint max_iterations;
+	complex julia_param;
+	complex center;
+	complex delta; // zoom level, the "lengths" of one pixel
+	complex phase; // fraction of a pixel the grid is moved by (0 or a half)
+	ullong reference = 0; // deep zoom: hash of the high precision centre the grid is relative to
+};
+
+// one tile of the cache
+
+struct cache_address
+{
+	cache_key key;
+	llong x;
+	llong y;
+};
+
+struct cache_address_hash
+{
+	size_t operator()(const cache_address& address) const;
+};
+
+bool operator==(const cache_address& a, const cache_address& b);
+ullong hash_combine(ullong hash, ullong value);
+
+class tile_cache
+{
+public:
+	explicit tile_cache(size_t budget = 256 << 20, size_t disk_budget = 1024 << 20);
+	~tile_cache(); // the changed tiles are written into the directory
+
+	// the memory the tiles can take up in bytes, setting a smaller one drops tiles right away
+	void set_budget(size_t budget);
+	size_t budget() const;
+	size_t size() const; // bytes taken up by the tiles now
+	size_t tile_count() const;
+	void clear();
+
+	// the directory the tiles are kept in on the disk, created when missing (empty for none)
+	void set_directory(const std::string& directory);
+	// the bytes the files of the tiles can take up, setting a smaller one deletes files right away
+	void set_disk_budget(size_t budget);
+	size_t disk_budget() const;
+	size_t disk_size() const; // bytes taken up by the files now
+	// writing the tiles changed since they were read or written last into the directory
+	void flush();
+	// the grid is met again after all (the view the program is closed with), its transient tiles are kept as the others
+	void persist(const cache_key& key);
+
+	// copying the cached pixels of the width x height rectangle with the corner left, top (pixels of the grid
+	// of the key) that aren't known yet into iterations, last_z and known, the rows are stride long
+	// returns the number of pixels copied
+	uint lookup(const cache_key& key, llong left, llong top, uint width, uint height, uint* iterations, complex* last_z, bool* known, uint stride);
+	// whether every pixel of the rectangle is cached
+	bool covers(const cache_key& key, llong left, llong top, uint width, uint height);
+	// adding the pixels of the rectangle to the cache, transient for a grid that can't come back (see above)
+	void store(const cache_key& key, llong left, llong top, uint width, uint height, const uint* iterations, const complex* last_z, uint stride,
+		bool transient = false);
+
+	// tiles found in memory, found on the disk and not found by lookup()
+	std::atomic<ullong> hits { 0 };
+	std::atomic<ullong> disk_hits { 0 };
+	std::atomic<ullong> misses { 0 };
+
+private:
+	struct tile
+	{
+		cache_address address;
+		std::vector<uint> iterations;
+		std::vector<complex> last_z;
+		std::vector<uint8_t> known;
+		uint known_count = 0;
+		bool dirty = false; // changed since it was written into the directory
+		bool transient = false;
+	};
+	typedef std::list<tile> tile_list;
+
+	size_t used() const; // size() without taking the lock
+	tile_list& list_of(const tile& cached);
+	tile_list::iterator find(const cache_address& address);
+	void evict();
+	void write(tile& cached);
+	void use_file(ullong hash);
+	void evict_files();
+	std::string file_name(const cache_address& address) const;
+	std::string file_name(ullong hash) const;
+
+	mutable std::mutex mutex;
+	size_t budget_bytes;
+	std::string directory;
+	tile_list tiles;		   // the most recently used first
+	tile_list transient_tiles; // the same for the grids that can't come back, evicted first
+	std::unordered_map<cache_address, tile_list::iterator, cache_address_hash> index;
+	// the files in the directory by the hash in their name, the most recently used first
+	size_t disk_budget_bytes;
+	std::list<ullong> files;
+	std::unordered_map<ullong, std::list<ullong>::iterator> file_index;
+};
+
+#endif // FRACTAL_TILE_CACHE_HPP
@@ -1,4 +1,8 @@
 //libraries
+#include "Fractal/Batch.hpp"
+#include "Fractal/Input.hpp"
+#include "Fractal/Render.hpp"
+#include "Fractal/Telemetry.hpp"
 #include "Platform/Platform.hpp"
 
 #include <cmath>
@@ -13,14 +17,6 @@
 #include <stdio.h>
 #include <sys/types.h>
 
-// complex number class for dealing with fractal generates via them
-
-struct complex
-{
-	double real;
-	double imag;
-};
-
 // button class for easier dealing and creating buttons used in the app
 
 class button
@@ -89,275 +85,16 @@ public:
 // their individual purposes are written below with their function definitions
 //
 
-uint mendel_iter(complex pos, uint max_iterations);
-sf::Color colour_palette(uint iterations);
-template <typename IterFunction, typename... Args>
-sf::Texture generate(uint width, uint height, complex top_left, complex bottom_right, uint max_iterations, IterFunction iter_fun, Args... args);
-uint mandelbrot_julia_iter(complex pos, uint max_iterations, complex point);
-sf::Texture which(uint which_one, int width, int height, complex top_left, complex bottom_right, uint max_iterations, complex julia_param);
-void update_julia_param(complex& julia_param, int width, int height, complex top_left, complex bottom_right, sf::Vector2i mouse_pos);
-void zoom(complex& top_left, complex& bottom_right, int width, int height, sf::Vector2i mouse_pos, sf::Event event, double zoom, double& zoomlvl);
-uint burning_ship_iter(complex pos, uint max_iterations);
-uint burning_ship_julia_iter(complex pos, uint max_iterations, complex point);
 std::string zoom_string(double zoom_lvl);
 std::string com_to_nice_str(complex position);
-void resizing(sf::RenderWindow& window, sf::Event& event, complex& top_left, complex& bottom_right, int& width, int& height, int& window_x, int& window_y);
+input_event resizing(sf::RenderWindow& window, sf::Event& event, int width, int height, int& window_x, int& window_y);
+void fit_window(sf::RenderWindow& window, framebuffer& frame_buffer, sf::Texture& fractal_txt, sf::Sprite& fractal, int width, int height);
+void resize_frame(framebuffer& frame_buffer, sf::Texture& fractal_txt, sf::Sprite& fractal, int width, int height);
+uint upload_tile(framebuffer& frame_buffer, sf::Texture& fractal_txt, uint tile);
 int file_count(std::string path);
 void save_image(sf::Texture& txt);
-void reset_view(complex& top_left, complex& bottom_right, double& zoomlvl);
-
-// function for calculating the number of iterations for some position pos in mandelbrot fractal
-
-uint mendel_iter(complex pos, uint max_iterations)
-{
-	// some variables that are used in the function or are used 2 times to slightly speed up the process
-	complex pos_copy = pos;
-	complex square;
-	square.real = pos.real * pos.real;
-	square.imag = pos.imag * pos.imag;
-	double xy = pos.imag * pos.real;
-
-	uint iter = 0;
-
-	// the formula for the mendelbrot fractal is z = z^2 + z0
-	// z is a complex number
-	// z0 is a starting number in this function 'pos'
-
-	while (square.real + square.imag < 4 && iter < max_iterations) // condition for escaping
-	{
-		// calculating z^2 + z0
-		double temp = square.real - square.imag + pos_copy.real;
-		pos.imag = xy + xy + pos_copy.imag;
-		pos.real = temp;
-		iter++;
-		//calculating the squared values for the check and the next iteration
-		square.real = pos.real * pos.real;
-		square.imag = pos.imag * pos.imag;
-		xy = pos.imag * pos.real;
-	}
-
-	return iter;
-}
-
-// function for calculating the number of iterations for some position pos in julia version of mandelbrot fractal with some point
-
-uint mandelbrot_julia_iter(complex pos, uint max_iterations, complex point)
-{
-	//some variables for slight optimization
-	complex square;
-	square.real = pos.real * pos.real;
-	square.imag = pos.imag * pos.imag;
-	double xy = pos.real * pos.imag;
-	uint iter = 0;
-	while (square.real + square.imag < 4 && iter < max_iterations) // escape condition
-	{
-		// z = z^2 + z_p
-		double temp = square.real - square.imag + point.real;
-		pos.imag = xy + xy + point.imag;
-		pos.real = temp;
-		iter++;
-		// calculating the square for the check the next iteration
-		square.real = pos.real * pos.real;
-		square.imag = pos.imag * pos.imag;
-		xy = pos.real * pos.imag;
-	}
-
-	return iter;
-}
-
-// function for calculating the number of iterations for some position pos of burning ship fractal
-
-uint burning_ship_iter(complex pos, uint max_iterations)
-{
-	// come variables for slight performance increase
-	complex copy = pos;
-	complex square;
-	square.real = pos.real * pos.real;
-	square.imag = pos.imag * pos.imag;
-	uint iter = 0;
-	while (square.real + square.imag < 4 && iter < max_iterations)
-	{
-		// z = (|a| + |b|i)^2 + z0
-		double temp = square.real - square.imag + copy.real;
-		pos.imag = 2 * std::abs(pos.real) * std::abs(pos.imag) + copy.imag;
-		pos.real = temp;
-		iter++;
-		// calculating the square for the check and the next iteration
-		square.real = pos.real * pos.real;
-		square.imag = pos.imag * pos.imag;
-	}
-	return iter;
-}
-
-// function for calculating the number of iterations for some position pos in julia version of burning ship fractal with some point
-
-uint burning_ship_julia_iter(complex pos, uint max_iterations, complex point)
-{
-	// variables for slight performance increase
-	uint iter = 0;
-	complex square;
-	square.real = pos.real * pos.real;
-	square.imag = pos.imag * pos.imag;
-	while (square.real + square.imag < 4 && iter < max_iterations)
-	{
-		// z = (|a| + |b|i)^2 + z_p
-		double temp = square.real - square.imag + point.real;
-		pos.imag = 2 * std::abs(pos.real) * std::abs(pos.imag) + point.imag;
-		pos.real = temp;
-		iter++;
-		// calculating squares for the check and the next iteration
-		square.real = pos.real * pos.real;
-		square.imag = pos.imag * pos.imag;
-	}
-	return iter;
-}
-
-// function to change the number of iterations the functions above return to a color of the pixel
-
-sf::Color colour_palette(uint iterations)
-{
-	sf::Color pixel;
-
-	uint8_t colour = iterations;
-
-	// simple colour palette
-
-	pixel.r = colour;	  // red
-	pixel.g = 2 * colour; // green
-	pixel.b = 3 * colour; // blue
-	pixel.a = 255;		  // alpha / opacity of this pixel
-
-	return pixel;
-}
-
-// a template for passing functions with different number of variables into this function
-template <typename IterFunction, typename... Args>
-
-// function generating a texture that is later dispalyed to the user
-
-sf::Texture generate(uint width, uint height, complex top_left, complex bottom_right, uint max_iterations, IterFunction iter_fun, Args... args)
-{
-	sf::Texture txt;
-	txt.create(width, height);
-
-	sf::Uint8* pixels = new sf::Uint8[width * height * 4]; // RGBA ( red green blue alpha ) color model is used by sf::texture
-
-	complex delta;
-	delta.real = (bottom_right.real - top_left.real) / (int)width;
-	delta.imag = (top_left.imag - bottom_right.imag) / (int)height;
-
-	complex pos = top_left;
-
-	// looping through all the pixels in the application window
-	for (uint x = 0; x < width; x++)
-	{
-		for (uint y = 0; y < height; y++)
-		{
-			// getting the number of iteration it takes for current point to escape
-			uint iter = iter_fun(pos, max_iterations, args...);
-			// calculating the index of the texture array of the current pixel
-			int arr_pos = 4 * (width * y + x);
-			// convering number of iteration to a colour
-			sf::Color p = colour_palette(iter);
-			// assigning values into the texture array
-			pixels[arr_pos] = p.r;
-			pixels[arr_pos + 1] = p.g;
-			pixels[arr_pos + 2] = p.b;
-			pixels[arr_pos + 3] = p.a;
-			// moving onto the position of the next pixel
-			pos.imag = pos.imag - delta.imag;
-		}
-		pos.real = pos.real + delta.real;
-		pos.imag = top_left.imag;
-	}
-	// updating our texture with the array
-	txt.update(pixels, width, height, 0, 0);
-
-	delete[] pixels;
-
-	return txt;
-}
-
-// a function to deretminate which fractal to generate
-
-sf::Texture which(uint which_one, int width, int height, complex top_left, complex bottom_right, uint max_iterations, complex julia_param)
-{
-	sf::Texture fractal;
-
-	switch (which_one)
-	{
-		case 0: // mandelbrot fractal
-			fractal = generate(width, height, top_left, bottom_right, max_iterations, mendel_iter);
-			break;
-		case 1: // julia verion of the mendelbrot fractal
-			fractal = generate(width, height, top_left, bottom_right, max_iterations, mandelbrot_julia_iter, julia_param);
-			break;
-		case 2: // burning ship fractal
-			fractal = generate(width, height, top_left, bottom_right, max_iterations, burning_ship_iter);
-			break;
-		case 3: // julia version of the burning ship fractal
-			fractal = generate(width, height, top_left, bottom_right, max_iterations, burning_ship_julia_iter, julia_param);
-			break;
-		default:
-			break;
-	}
-
-	return fractal;
-}
-
-// function for updating the julia parameter used in some fractals upon clicking
-
-void update_julia_param(complex& julia_param, int width, int height, complex top_left, complex bottom_right, sf::Vector2i mouse_pos)
-{
-	// calculating "lengths" of one pixel
-	complex d;
-	d.real = (bottom_right.real - top_left.real) / width;
-	d.imag = (top_left.imag - bottom_right.imag) / height;
-
-	julia_param.real = top_left.real + d.real * mouse_pos.x;
-	julia_param.imag = top_left.imag - d.imag * mouse_pos.y;
-}
-
-// function for calculating new parameters upon zooming
-
-void zoom(complex& top_left, complex& bottom_right, int width, int height, sf::Vector2i mouse_pos, sf::Event event, double zoom, double& zoomlvl)
-{
-	// calculating the size of area dispalyed by the window
-	complex size;
-	size.real = (top_left.real + bottom_right.real) / 2.;
-	size.imag = (top_left.imag + bottom_right.imag) / 2.;
-
-	size.real = size.real - top_left.real;
-	size.imag = size.imag - bottom_right.imag;
-
-	// scaling the size of the area depending of the zoom
-	if (event.mouseWheelScroll.delta > 0) // zoom in
-	{
-		size.real = size.real / zoom;
-		size.imag = size.imag / zoom;
-		zoomlvl = zoomlvl * zoom;
-	}
-	else // zoom out
-	{
-		size.real = size.real * zoom;
-		size.imag = size.imag * zoom;
-		zoomlvl = zoomlvl / zoom;
-	}
-	// "lengths" of one pixel
-	complex d;
-	d.real = (bottom_right.real - top_left.real) / width;
-	d.imag = (top_left.imag - bottom_right.imag) / height;
-
-	complex new_center;
-	new_center.real = top_left.real + mouse_pos.x * d.real;
-	new_center.imag = top_left.imag - mouse_pos.y * d.imag;
-
-	top_left.real = new_center.real - size.real;
-	top_left.imag = new_center.imag + size.imag;
-
-	bottom_right.real = new_center.real + size.real;
-	bottom_right.imag = new_center.imag - size.imag;
-}
+void save_session(std::string path, const deep_view& view, uint which_one, uint max_iterations, complex julia_param, double zoomlvl);
+bool load_session(std::string path, deep_view& view, uint& which_one, uint& max_iterations, complex& julia_param, double& zoomlvl);
 
 //  function for writing a zoom lvl in a nice way
 // from 0 to 100 a value with a few decimals points is displayed
@@ -403,43 +140,82 @@ std::string com_to_nice_str(complex position)
 }
 
 // function for calculating new parameters upon resizing the window
+// the middle of the view moves so the wall that wasn't dragged stays in place, the input says by how much
 
-void resizing(sf::RenderWindow& window, sf::Event& event, complex& top_left, complex& bottom_right, int& width, int& height, int& window_x, int& window_y)
+input_event resizing(sf::RenderWindow& window, sf::Event& event, int width, int height, int& window_x, int& window_y)
 {
-	// "lengths" of one pixel
-	complex d;
-	d.real = (bottom_right.real - top_left.real) / width;
-	d.imag = (top_left.imag - bottom_right.imag) / height;
+	input_event input;
+	input.kind = input_kind::resize;
+	input.x = event.size.width;
+	input.y = event.size.height;
+
 	// the amount the window was resized by
 	int d_x = event.size.width - width;
 	int d_y = event.size.height - height;
-	// which wall was rezised
+	// which wall was rezised, the opposite wall stays in place so the middle of the view moves by half of it
 	if (window_x == window.getPosition().x) // right wall
 	{
-		bottom_right.real = bottom_right.real + d.real * d_x;
+		input.move_x = d_x / 2.;
 	}
 	else // left wall
 	{
-		top_left.real = top_left.real - d.real * d_x;
+		input.move_x = -d_x / 2.;
 	}
 	if (window_y == window.getPosition().y) // down wall
 	{
-		bottom_right.imag = bottom_right.imag - d.imag * d_y;
+		input.move_y = d_y / 2.;
 	}
 	else // top wall
 	{
-		top_left.imag = top_left.imag + d.imag * d_y;
+		input.move_y = -d_y / 2.;
 	}
 
-	width = event.size.width;
-	height = event.size.height;
 	// window position on the screen
 	window_x = window.getPosition().x;
 	window_y = window.getPosition().y;
 
+	return input;
+}
+
+// function for fitting the window to the size of the view after it was resized (or a replay resized the view)
+
+void fit_window(sf::RenderWindow& window, framebuffer& frame_buffer, sf::Texture& fractal_txt, sf::Sprite& fractal, int width, int height)
+{
+	if (window.getSize().x != (uint)width || window.getSize().y != (uint)height)
+		window.setSize(sf::Vector2u(width, height));
+
 	//creating a rectangle and setting the view of the window to it to update the window
 	sf::FloatRect visibleArea(0, 0, width, height);
 	window.setView(sf::View(visibleArea));
+
+	resize_frame(frame_buffer, fractal_txt, fractal, width, height);
+}
+
+//  function for reallocating the framebuffer and the texture the fractal is drawn with
+// this is the only place they get reallocated, every frame of the same size reuses them
+
+void resize_frame(framebuffer& frame_buffer, sf::Texture& fractal_txt, sf::Sprite& fractal, int width, int height)
+{
+	if (fractal_txt.getSize().x == (uint)width && fractal_txt.getSize().y == (uint)height)
+		return;
+
+	frame_buffer.resize(width, height);
+
+	fractal_txt.create(width, height);
+	fractal.setTexture(fractal_txt);
+	fractal.setTextureRect(sf::IntRect(sf::Vector2i(0, 0), sf::Vector2i(width, height)));
+}
+
+//  function for copying one tile of the framebuffer into the texture
+// the workers of the frame may be writing the next progressive pass of the tile, so it is copied under its mutex
+// returns the number of bytes uploaded
+
+uint upload_tile(framebuffer& frame_buffer, sf::Texture& fractal_txt, uint tile)
+{
+	sf::IntRect rect = frame_buffer.tile_rect(tile);
+	std::lock_guard<std::mutex> lock(frame_buffer.tile_mutex(tile));
+	fractal_txt.update(frame_buffer.tile_pixels(tile), rect.width, rect.height, rect.left, rect.top);
+	return 4 * rect.width * rect.height;
 }
 
 //  function counting how many files are in a directory
@@ -481,21 +257,159 @@ void save_image(sf::Texture& txt)
 	}
 }
 
-// function to reset the view back the begining
+// functions for remembering the view between the runs of the program, the tiles of it are in the tile cache
+// so the last view shows up right away, the doubles are written in hex so they come back exactly
 
-void reset_view(complex& top_left, complex& bottom_right, double& zoomlvl)
+static void write_big(std::ofstream& file, const big_fixed& a)
 {
-	zoomlvl = 1;
+	file << a.negative << ' ' << a.limbs.size();
+	for (uint limb : a.limbs)
+		file << ' ' << limb;
+	file << '\n';
+}
 
-	top_left.real = -2;
-	top_left.imag = 2;
+static bool read_big(std::ifstream& file, big_fixed& a)
+{
+	size_t count = 0;
+	if (!(file >> a.negative >> count) || count == 0 || count > 1 << 16)
+		return false;
+	a.limbs.resize(count);
+	for (uint& limb : a.limbs)
+		file >> limb;
+	return (bool)file;
+}
 
-	bottom_right.real = 2;
-	bottom_right.imag = -2;
+static bool read_double(std::ifstream& file, double& value)
+{
+	std::string text;
+	if (!(file >> text))
+		return false;
+	char* end = nullptr;
+	value = std::strtod(text.c_str(), &end);
+	return end != text.c_str() && std::isfinite(value);
 }
 
-int main()
+void save_session(std::string path, const deep_view& view, uint which_one, uint max_iterations, complex julia_param, double zoomlvl)
 {
+	std::ofstream file(path, std::ios::trunc);
+	file << which_one << ' ' << max_iterations << '\n'
+		 << std::hexfloat << julia_param.real << ' ' << julia_param.imag << ' ' << zoomlvl << '\n'
+		 << view.pixel.real << ' ' << view.pixel.imag << '\n';
+	write_big(file, view.center_real);
+	write_big(file, view.center_imag);
+}
+
+bool load_session(std::string path, deep_view& view, uint& which_one, uint& max_iterations, complex& julia_param, double& zoomlvl)
+{
+	std::ifstream file(path);
+	deep_view loaded;
+	uint fractal = 0;
+	uint iterations = 0;
+	complex param;
+	double zoom = 0;
+	bool read = file >> fractal >> iterations && read_double(file, param.real) && read_double(file, param.imag)
+		&& read_double(file, zoom) && read_double(file, loaded.pixel.real) && read_double(file, loaded.pixel.imag)
+		&& read_big(file, loaded.center_real) && read_big(file, loaded.center_imag);
+	if (!read || fractal > 3 || iterations < 16 || iterations > 1u << 20 || !(loaded.pixel.real > 0) || !(loaded.pixel.imag > 0))
+		return false;
+
+	view = loaded;
+	which_one = fractal;
+	max_iterations = iterations;
+	julia_param = param;
+	zoomlvl = zoom;
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	// started with --render, --batch, --benchmark or --help the program only renders images, without opening a window
+	// (see Batch.hpp), otherwise it takes only the options of the window itself:
+	//  --telemetry frames.csv                     what its frames cost is written into the file (see Telemetry.hpp)
+	//  --record session.txt                       the inputs are written into the file (see Input.hpp)
+	//  --replay session.txt [--headless]          the recorded inputs are played back, without a window when headless
+
+	// the mode is picked once, from the options that only the batch mode has, so an option of the other mode
+	// (or a typo) is reported instead of silently starting the batch mode with everything
+	const char* batch_options[] = { "--render", "--batch", "--benchmark", "--help", "-h" };
+	for (int i = 1; i < argc; i++)
+		for (const char* batch_option : batch_options)
+			if (argv[i] == std::string(batch_option))
+				return batch_main(argc, argv);
+
+	// all the options are read before any file is opened, a wrong one mustn't leave a truncated file behind
+	std::string telemetry_path;
+	std::string record_path;
+	std::string replay_path;
+	bool headless = false;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string option = argv[i];
+		std::string* value = nullptr;
+		if (option == "--headless")
+			headless = true;
+		else if (option == "--telemetry")
+			value = &telemetry_path;
+		else if (option == "--record")
+			value = &record_path;
+		else if (option == "--replay")
+			value = &replay_path;
+		else
+		{
+			std::cerr << "unknown option " << option << " (--help lists the options of the batch mode)" << std::endl;
+			return 1;
+		}
+		if (value)
+		{
+			if (i + 1 >= argc)
+			{
+				std::cerr << "missing value of " << option << std::endl;
+				return 1;
+			}
+			*value = argv[++i];
+		}
+	}
+	bool replaying = !replay_path.empty();
+	if (headless && !replaying)
+	{
+		std::cerr << "--headless goes with --replay" << std::endl;
+		return 1;
+	}
+
+	std::vector<input_event> replay;
+	if (replaying)
+	{
+		std::string error;
+		if (!load_inputs(replay_path, replay, error))
+		{
+			std::cerr << error << std::endl;
+			return 1;
+		}
+	}
+	input_recorder recorder;
+	if (!record_path.empty() && !recorder.open(record_path))
+	{
+		std::cerr << "Can't write " << record_path << std::endl;
+		return 1;
+	}
+	telemetry_log telemetry;
+	if (!telemetry_path.empty() && !telemetry.open(telemetry_path))
+		std::cerr << "Can't write " << telemetry_path << std::endl;
+
+	// the latencies of a replay without a window, the tiles are only cached in memory so every run is the same
+	if (headless)
+	{
+		tile_cache cache(256 << 20);
+		latency_tracker latency;
+		uint frames = replay_headless(replay, render_pool(), &cache, latency);
+		std::cout << "Replayed " << replay.size() << " inputs, " << frames << " frames started" << std::endl;
+		std::cout << "Input to frame latency: " << percentiles_text(time_percentiles(latency.latencies)) << std::endl;
+		return 0;
+	}
+
+	// picking the fastest escape time kernels this processor supports
+	std::cout << "Escape time kernels: " << simd_level_name(best_row_kernels().level) << std::endl;
+
 	//loading the font
 	sf::Font roboto;
 	roboto.loadFromFile("src\\Roboto-Black.ttf");
@@ -525,7 +439,14 @@ int main()
 	julia_parameter.setString("Julia Parameter: \n0 + 0i");
 	julia_parameter.setPosition(7, 105);
 
-	button options_panel(-5, -5, 325, 505);
+	sf::Text iterations_text;
+	iterations_text.setFont(roboto);
+	iterations_text.setCharacterSize(30);
+	iterations_text.setStyle(sf::Text::Regular);
+	iterations_text.setString("Iterations: 255");
+	iterations_text.setPosition(7, 510);
+
+	button options_panel(-5, -5, 325, 555);
 	options_panel.rectangle.setFillColor(sf::Color(69, 69, 69, 255));
 	options_panel.rectangle.setOutlineColor(sf::Color(164, 164, 164, 255));
 
@@ -584,7 +505,10 @@ int main()
 	help_button_text.setString("Help");
 	help_button_text.setPosition(37, 420);
 
-	button help_panel(200, 200, 400, 400);
+	// the help panel doesn't change size when the window does, it only stays in the middle of it
+	const int help_panel_width = 400;
+	const int help_panel_height = 440;
+	button help_panel(400 - help_panel_width / 2, 200, help_panel_width, help_panel_height);
 	help_panel.rectangle.setFillColor(sf::Color(155, 155, 0, 255));
 	help_panel.rectangle.setOutlineColor(sf::Color(101, 101, 0, 255));
 
@@ -592,7 +516,7 @@ int main()
 	help_panel_text.setFont(roboto);
 	help_panel_text.setCharacterSize(15);
 	help_panel_text.setStyle(sf::Text::Regular);
-	help_panel_text.setString("Keys:\nh  - hide/enable side panel\nf1 - help(this)\nr - come back to the starting view\n\nMouse:\nleft mouse button - set the position of\n\t\t\t\t\t\t\t\t\tJulia Parameter\nscroll - zoom in/out\n\t\t\t  When zooming the place of the cursor\n\t\t\t  becames the middle of the screen.\n\nPictures are saved into pictures folder\nsaved pictures are named:\nimage_{number of pictures in the folder + 1}.png\n\nTo exit this panel press outside of it");
+	help_panel_text.setString("Keys:\nh  - hide/enable side panel\nf1 - help(this)\nf3 - render times\nr - come back to the starting view\narrows, right mouse drag - move the view\n+/- - double/halve the number of iterations\np/s/c - palette/smooth colours/colour cycling\n[ ] - less/more contrast\n\nMouse:\nleft mouse button - set the position of\n\t\t\t\t\t\t\t\t\tJulia Parameter\nscroll - zoom in/out\nz - zoom 2x on the grid of the pixels (faster)\n\t\t\t  When zooming the place of the cursor\n\t\t\t  becames the middle of the screen.\n\nPictures are saved into pictures folder\nsaved pictures are named:\nimage_{number of pictures in the folder + 1}.png\n\nTo exit this panel press outside of it");
 	help_panel_text.setPosition(210, 210);
 
 	button save_button(140, 400, 110, 100 / 1.618);
@@ -606,6 +530,19 @@ int main()
 	save_button_text.setString("Save Image");
 	save_button_text.setPosition(153, 420);
 
+	// what the frames cost, in the top right corner
+
+	const int stats_panel_height = 210;
+	button stats_panel(800 - 270, -5, 275, stats_panel_height);
+	stats_panel.rectangle.setFillColor(sf::Color(69, 69, 69, 200));
+	stats_panel.rectangle.setOutlineColor(sf::Color(164, 164, 164, 255));
+
+	sf::Text stats_panel_text;
+	stats_panel_text.setFont(roboto);
+	stats_panel_text.setCharacterSize(15);
+	stats_panel_text.setStyle(sf::Text::Regular);
+	stats_panel_text.setPosition(800 - 255, 7);
+
 	//
 	//  initialization of parameters used in the application
 	//
@@ -614,38 +551,74 @@ int main()
 
 	bool help_panel_visible = false;
 
-	// which fractal is being displayed
-	uint which_one = 0;
+	bool stats_visible = false;
 
-	double zoomlvl = 1;
+	// what is displayed: the fractal, the view, the iterations and the colours (see Input.hpp)
+	explorer_state state;
 
-	int width = 800;
-	int height = 800;
+	bool recolour_frame = false;
+	sf::Clock cycling_clock;
 
-	uint max_iterations = 255;
+	// has to be there before the window, on linux it makes xlib safe for threads before anything else uses it
+	util::Platform platform;
 
-	sf::RenderWindow window(sf::VideoMode(width, height), "Eksplorator fraktali");
+	sf::RenderWindow window(sf::VideoMode(state.width, state.height), "Eksplorator fraktali");
+
+	// the window is drawn at most once per refresh of the monitor it is on
+	const int refresh_rate = std::max(platform.getRefreshRate(window.getSystemHandle()), 1);
+	const sf::Time frame_interval = sf::seconds(1.f / refresh_rate);
+	sf::Clock pace_clock;
+	std::cout << "Refresh rate: " << refresh_rate << " Hz" << std::endl;
 
 	int window_x = window.getPosition().x;
 	int window_y = window.getPosition().y;
 
-	complex top_left;
-	top_left.real = -2;
-	top_left.imag = 2;
-
-	complex bottom_right;
-	bottom_right.real = 2;
-	bottom_right.imag = -2;
+	reset_view(state.view, state.top_left, state.bottom_right, state.width, state.height, state.zoomlvl);
 
-	complex julia_param;
-	julia_param.real = 0;
-	julia_param.imag = 0;
+	// the right mouse button drags the view, holding the left one moves the julia parameter
+	bool dragging = false;
+	sf::Vector2i drag_pos;
+	bool picking = false;
 
 	// did something happen that needs updating the displayed fractal
 	bool update = 1;
 
-	sf::Texture fractal_txt; // texture can be built from an array
-	sf::Sprite fractal;		 // sprite can be displayed
+	framebuffer frame_buffer; // pixels of the fractal, rendered in the background
+	tile_cache cache(256 << 20); // the tiles seen before, going back to them (r, zooming back out) doesn't compute them again
+	frame_buffer.cache = &cache;
+	// the tiles are kept on the disk as well, together with the view the program was closed with
+	// a recorded session starts from the starting view and a replay doesn't use the tiles of the earlier runs
+	const std::string cache_path = "./cache/";
+	const bool keep_session = !recorder.is_open() && !replaying;
+	if (keep_session)
+	{
+		cache.set_directory(cache_path);
+		if (load_session(cache_path + "session.txt", state.view, state.which_one, state.max_iterations, state.julia_param, state.zoomlvl))
+			view_corners(state.view, state.width, state.height, state.top_left, state.bottom_right);
+	}
+	sf::Texture fractal_txt;  // texture can be built from an array
+	sf::Sprite fractal;		  // sprite can be displayed
+
+	resize_frame(frame_buffer, fractal_txt, fractal, state.width, state.height);
+
+	std::shared_ptr<render_job> job; // frame being rendered in the background
+	bool reported = true;			 // the stats of the frame were taken
+
+	frame_stats rendering;		// the frame being rendered
+	frame_stats rendered;		// the last frame that was rendered to the end, shown by the stats panel
+	uint frames_started = 0;
+	double last_draw_seconds = 0;
+
+	// the inputs of one pass of the loop, from the mouse and the keyboard or from the replay
+	std::vector<input_event> inputs;
+	size_t replayed = 0;
+	sf::Clock session_clock;
+	latency_tracker latency;
+	std::vector<double> window_frames; // the time between the frames of the window, kept while recording or replaying
+	sf::Clock window_frame_clock;
+	bool texts_changed = true;
+	// something changed on the screen since it was drawn last time
+	bool redraw = true;
 
 	while (window.isOpen())
 	{
@@ -653,16 +626,26 @@ int main()
 		// event handling
 		//
 
+		// when nothing is going on (no frame being rendered, no colour cycling, no replay) the loop sleeps until
+		// the next event instead of drawing the same picture again and again, a frame that got done since the last
+		// pass still has its last tiles to upload
+		const bool idle = !update && !recolour_frame && !redraw && !state.colour_cycling && !replaying && !(job && (!job->done() || !reported));
+
+		inputs.clear();
+
 		sf::Event event;
-		while (window.pollEvent(event))
+		bool has_event = idle ? window.waitEvent(event) : window.pollEvent(event);
+		for (; has_event; has_event = window.pollEvent(event))
 		{
+			redraw = true;
+
 			// X button
 			if (event.type == sf::Event::Closed)
 				window.close();
 			// mouse presses
-			if (sf::Mouse::isButtonPressed(sf::Mouse::Left))
+			if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left)
 			{
-				sf::Vector2i mouse_pos = sf::Mouse::getPosition(window);
+				sf::Vector2i mouse_pos(event.mouseButton.x, event.mouseButton.y);
 
 				if (help_panel_visible)
 				{
@@ -675,25 +658,28 @@ int main()
 				{
 					if (options_panel.is_pressed(mouse_pos) && ui_visible)
 					{
+						input_event input;
+						input.kind = input_kind::fractal;
+						input.value = -1;
 						if (menel_buttn.is_pressed(mouse_pos))
 						{
-							which_one = 0;
-							update = 1;
+							input.value = 0;
 						}
 						if (mendel_julia_button.is_pressed(mouse_pos))
 						{
-							which_one = 1;
-							update = 1;
+							input.value = 1;
 						}
 						if (burning_shop_button.is_pressed(mouse_pos))
 						{
-							which_one = 2;
-							update = 1;
+							input.value = 2;
 						}
 						if (burning_ship_julia_button.is_pressed(mouse_pos))
 						{
-							which_one = 3;
-							update = 1;
+							input.value = 3;
+						}
+						if (input.value >= 0)
+						{
+							inputs.push_back(input);
 						}
 						if (help_button.is_pressed(mouse_pos))
 						{
@@ -706,36 +692,70 @@ int main()
 					}
 					else
 					{
-						update_julia_param(julia_param, width, height, top_left, bottom_right, mouse_pos);
-
-						julia_parameter.setString("Julia Parameter: \n" + com_to_nice_str(julia_param));
-
-						if (which_one == 1 || which_one == 3)
-						{
-							update = 1;
-						}
+						picking = true;
 					}
 				}
 			}
+			if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Left)
+			{
+				picking = false;
+			}
+
+			// picking the julia parameter, it follows the cursor while the left button is held
+
+			if (picking && (event.type == sf::Event::MouseButtonPressed || event.type == sf::Event::MouseMoved))
+			{
+				input_event input;
+				input.kind = input_kind::julia;
+				input.x = event.type == sf::Event::MouseMoved ? event.mouseMove.x : event.mouseButton.x;
+				input.y = event.type == sf::Event::MouseMoved ? event.mouseMove.y : event.mouseButton.y;
+				inputs.push_back(input);
+			}
+
+			// dragging the view with the right mouse button
+
+			if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Right)
+			{
+				dragging = true;
+				drag_pos = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+			}
+			if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Right)
+			{
+				dragging = false;
+			}
+			if (event.type == sf::Event::MouseMoved && dragging)
+			{
+				sf::Vector2i mouse_pos(event.mouseMove.x, event.mouseMove.y);
+				input_event input;
+				input.kind = input_kind::pan;
+				input.x = drag_pos.x - mouse_pos.x;
+				input.y = drag_pos.y - mouse_pos.y;
+				inputs.push_back(input);
+				drag_pos = mouse_pos;
+			}
 
-			// Keyboard presses
+			// Keyboard presses, the ones that only show or hide the panels aren't inputs
 
 			if (event.type == sf::Event::KeyPressed)
 			{
-				if (sf::Keyboard::isKeyPressed(sf::Keyboard::H))
+				if (event.key.code == sf::Keyboard::H)
 				{
 					ui_visible = !ui_visible;
 				}
-				if (sf::Keyboard::isKeyPressed(sf::Keyboard::F1))
+				else if (event.key.code == sf::Keyboard::F1)
 				{
 					help_panel_visible = !help_panel_visible;
 				}
-				if (sf::Keyboard::isKeyPressed(sf::Keyboard::R))
+				else if (event.key.code == sf::Keyboard::F3)
 				{
-					reset_view(top_left, bottom_right, zoomlvl);
-					position.setString("Position: \n0 + 0i");
-					zoomtxt.setString("Zoom: 1");
-					update = 1;
+					stats_visible = !stats_visible;
+				}
+				else
+				{
+					input_event input;
+					input.kind = input_kind::key;
+					input.value = event.key.code;
+					inputs.push_back(input);
 				}
 			}
 
@@ -743,81 +763,231 @@ int main()
 
 			if (event.type == sf::Event::MouseWheelScrolled)
 			{
-				double zom = 1.1;
-				sf::Vector2i mouse_pos = sf::Mouse::getPosition(window);
+				input_event input;
+				input.kind = input_kind::wheel;
+				input.delta = event.mouseWheelScroll.delta;
+				input.x = event.mouseWheelScroll.x;
+				input.y = event.mouseWheelScroll.y;
+				inputs.push_back(input);
+			}
 
-				zoom(top_left, bottom_right, width, height, mouse_pos, event, zom, zoomlvl);
+			// resizing the window, the resizes a replay makes itself are left out
 
-				zoomtxt.setString("Zoom: " + zoom_string(zoomlvl));
+			if (event.type == sf::Event::Resized && ((int)event.size.width != state.width || (int)event.size.height != state.height))
+			{
+				inputs.push_back(resizing(window, event, state.width, state.height, window_x, window_y));
+			}
+		}
+		const double now = session_clock.getElapsedTime().asSeconds();
 
-				complex center;
-				center.real = (top_left.real + bottom_right.real) / 2;
-				center.imag = (top_left.imag + bottom_right.imag) / 2;
+		// a replay ignores the mouse and the keyboard and takes the recorded inputs whose time has come
+		if (replaying)
+		{
+			inputs.clear();
+			for (; replayed < replay.size() && replay[replayed].time <= now; replayed++)
+				inputs.push_back(replay[replayed]);
+		}
+		// the whole burst of the wheel is one zoom and one frame
+		coalesce_wheel(inputs);
 
-				position.setString("Position: \n" + com_to_nice_str(center));
+		for (input_event& input : inputs)
+		{
+			redraw = true;
+			if (!replaying)
+				input.time = now;
+			recorder.record(input);
 
+			input_effect effect = apply_input(state, input);
+			if (effect.update)
+			{
 				update = 1;
+				latency.input(input.time);
 			}
-
-			// resizing the window
-
-			if (event.type == sf::Event::Resized)
+			recolour_frame |= effect.recolour;
+			if (effect.cycling)
+				cycling_clock.restart();
+			if (effect.resized)
 			{
-				resizing(window, event, top_left, bottom_right, width, height, window_x, window_y);
+				fit_window(window, frame_buffer, fractal_txt, fractal, state.width, state.height);
 
-				complex center;
-				center.real = (top_left.real + bottom_right.real) / 2;
-				center.imag = (top_left.imag + bottom_right.imag) / 2;
+				help_panel.update(state.width / 2 - help_panel_width / 2, state.height / 2 - 200, help_panel_width, help_panel_height);
+				help_panel_text.setPosition(state.width / 2 - 190, state.height / 2 - 190);
+				stats_panel.update(state.width - 270, -5, 275, stats_panel_height);
+				stats_panel_text.setPosition(state.width - 255, 7);
+			}
+			texts_changed = true;
+		}
 
-				position.setString("Position: \n" + com_to_nice_str(center));
+		// the texts of the side panel follow the state
+		if (texts_changed)
+		{
+			complex center;
+			center.real = (state.top_left.real + state.bottom_right.real) / 2;
+			center.imag = (state.top_left.imag + state.bottom_right.imag) / 2;
+
+			zoomtxt.setString("Zoom: " + zoom_string(state.zoomlvl));
+			position.setString("Position: \n" + com_to_nice_str(center));
+			julia_parameter.setString("Julia Parameter: \n" + com_to_nice_str(state.julia_param));
+			iterations_text.setString("Iterations: " + std::to_string(state.max_iterations));
+			texts_changed = false;
+		}
 
-				help_panel.update(width / 2 - 200, height / 2 - 200, 400, 400); // help panel doesn't change size and is in the middle of the screen
-				help_panel_text.setPosition(width / 2 - 190, height / 2 - 190);
+		// colour cycling moves the colours along the palette 30 steps per second
+		if (state.colour_cycling)
+		{
+			state.colours.offset += 30 * cycling_clock.restart().asSeconds();
+			recolour_frame = 1;
+		}
 
+		// a finished frame is only coloured again, a frame that is still being rendered is started over with the new colours
+		if (recolour_frame && !update)
+		{
+			if (job && job->done())
+			{
+				recolour(frame_buffer, state.colours, job->frame.max_iterations);
+				for (uint tile = 0; tile < frame_buffer.tile_count(); tile++)
+					upload_tile(frame_buffer, fractal_txt, tile);
+				redraw = true;
+			}
+			else if (!state.colour_cycling)
+			{
 				update = 1;
 			}
 		}
-		// updating the displayed fractal
-		if (update)
+		recolour_frame = 0;
+
+		// starting to render the displayed fractal in the background
+		// the frame that was being rendered so far is not needed anymore and gets cancelled by which()
+		// a frame that only computes the strips of a moved view is quick, it is finished first so the next
+		// one can take over its pixels as well
+		if (update && !(job && job->reused.width > 0 && !job->done()))
 		{
-			fractal_txt = which(which_one, width, height, top_left, bottom_right, max_iterations, julia_param);
-			fractal.setTexture(fractal_txt);
-			fractal.setTextureRect(sf::IntRect(sf::Vector2i(0, 0), sf::Vector2i(width, height)));
+			latency.frame_started(now, job && !job->done());
+			job = which(render_pool(), frame_buffer, state_frame(state));
 			update = 0;
+			reported = false;
+
+			rendering = frame_stats();
+			rendering.number = ++frames_started;
+			// the stats panel shows the frame is being rendered
+			redraw = true;
 		}
 
-		//
-		// drawing all the necessary stuff in the window
-		//
+		// uploading the tiles that were finished since the last frame straight from the framebuffer
+		// so the screen fills in as they arrive, tiles of the cancelled frames are skipped
+		bool frame_done = job && job->done();
+		sf::Clock upload_clock;
+		finished_tile finished;
+		while (frame_buffer.finished->pop(finished))
+		{
+			if (finished.generation != frame_buffer.generation)
+				continue;
 
-		window.clear(sf::Color::Blue);
+			rendering.bytes_uploaded += upload_tile(frame_buffer, fractal_txt, finished.tile);
+			redraw = true;
+		}
+		// some tiles didn't fit into the queue, the whole frame is uploaded instead
+		if (frame_buffer.overflowed.exchange(false))
+		{
+			for (uint tile = 0; tile < frame_buffer.tile_count(); tile++)
+				rendering.bytes_uploaded += upload_tile(frame_buffer, fractal_txt, tile);
+			redraw = true;
+		}
+		rendering.upload_seconds += upload_clock.getElapsedTime().asSeconds();
 
-		window.draw(fractal);
-		if (ui_visible)
+		// the stats of the finished frame, for the stats panel and the telemetry file
+		if (frame_done && !reported && !job->cancelled())
 		{
-			window.draw(options_panel.rectangle);
-			window.draw(zoomtxt);
-			window.draw(position);
-			window.draw(julia_parameter);
-			window.draw(menel_buttn.rectangle);
-			window.draw(menel_buttn_text);
-			window.draw(mendel_julia_button.rectangle);
-			window.draw(mendel_julia_button_text);
-			window.draw(burning_shop_button.rectangle);
-			window.draw(burning_shop_button_text);
-			window.draw(burning_ship_julia_button.rectangle);
-			window.draw(burning_ship_julia_text);
-			window.draw(help_button.rectangle);
-			window.draw(help_button_text);
-			window.draw(save_button.rectangle);
-			window.draw(save_button_text);
+			finish_stats(rendering, *job);
+			rendered = rendering;
+			telemetry.write(rendered);
+			latency.frame_done(session_clock.getElapsedTime().asSeconds());
 		}
-		if (help_panel_visible)
+		if (frame_done)
+			reported = true;
+
+		// the replay is over once its last input was applied and the frame it shows is done
+		if (replaying && replayed == replay.size() && frame_done && !update)
+			window.close();
+
+		//
+		// drawing all the necessary stuff in the window
+		//
+
+		// only when something changed, the finished frame stays on the screen without drawing it again
+		if (redraw)
 		{
-			window.draw(help_panel.rectangle);
-			window.draw(help_panel_text);
+			sf::Clock draw_clock;
+			window.clear(sf::Color::Blue);
+
+			window.draw(fractal);
+			if (ui_visible)
+			{
+				window.draw(options_panel.rectangle);
+				window.draw(zoomtxt);
+				window.draw(position);
+				window.draw(julia_parameter);
+				window.draw(iterations_text);
+				window.draw(menel_buttn.rectangle);
+				window.draw(menel_buttn_text);
+				window.draw(mendel_julia_button.rectangle);
+				window.draw(mendel_julia_button_text);
+				window.draw(burning_shop_button.rectangle);
+				window.draw(burning_shop_button_text);
+				window.draw(burning_ship_julia_button.rectangle);
+				window.draw(burning_ship_julia_text);
+				window.draw(help_button.rectangle);
+				window.draw(help_button_text);
+				window.draw(save_button.rectangle);
+				window.draw(save_button_text);
+			}
+			if (help_panel_visible)
+			{
+				window.draw(help_panel.rectangle);
+				window.draw(help_panel_text);
+			}
+			if (stats_visible)
+			{
+				stats_panel_text.setString(stats_text(rendered, job && !job->done(), last_draw_seconds));
+				window.draw(stats_panel.rectangle);
+				window.draw(stats_panel_text);
+			}
+			window.display();
+			last_draw_seconds = draw_clock.getElapsedTime().asSeconds();
+			if (recorder.is_open() || replaying)
+				window_frames.push_back(window_frame_clock.restart().asSeconds());
+			if (!reported)
+			{
+				rendering.draw_seconds += last_draw_seconds;
+				rendering.window_frames++;
+			}
+			redraw = false;
 		}
-		window.display();
+
+		// while the fractal is being rendered the loop runs once per refresh, the tiles finished in between are
+		// uploaded together and the threads of the pool get the processor the rest of the time
+		sf::Time left = frame_interval - pace_clock.getElapsedTime();
+		if (left.asMicroseconds() > 0)
+			sf::sleep(left);
+		pace_clock.restart();
+	}
+
+	// the remaining tiles don't have to be rendered before the thread pool shuts down
+	frame_buffer.cancel();
+	frame_buffer.wait_idle();
+
+	if (keep_session)
+	{
+		save_session(cache_path + "session.txt", state.view, state.which_one, state.max_iterations, state.julia_param, state.zoomlvl);
+		// the tiles are only written when they are evicted and here, the view of the session is met again on the next run
+		if (job && job->cached)
+			cache.persist(job->key);
+		cache.flush();
+	}
+	else
+	{
+		std::cout << "Input to frame latency: " << percentiles_text(time_percentiles(latency.latencies)) << std::endl;
+		std::cout << "Window frame time: " << percentiles_text(time_percentiles(window_frames)) << std::endl;
 	}
 
 	return 0;
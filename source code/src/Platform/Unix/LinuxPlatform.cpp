@@ -2,6 +2,7 @@
 	#include "Platform/Unix/LinuxPlatform.hpp"
 
 	#include <X11/Xlib.h>
+	#include <X11/extensions/Xrandr.h>
 
 namespace util
 {
@@ -43,12 +44,90 @@ float LinuxPlatform::getScreenScalingFactor(const sf::WindowHandle& inHandle)
 }
 
 /******************************************************************************
- *
+ * Refresh rate of an XRandR mode: the pixel clock over the pixels of a whole
+ * frame, blanking included. Interlaced modes show two fields per frame and
+ * double scanned ones every line twice
+ *****************************************************************************/
+static double getModeRefreshRate(const XRRScreenResources* inResources, const RRMode inMode)
+{
+	for (int i = 0; i < inResources->nmode; ++i)
+	{
+		const XRRModeInfo& mode = inResources->modes[i];
+		if (mode.id != inMode || mode.hTotal == 0 || mode.vTotal == 0)
+			continue;
+
+		double verticalTotal = mode.vTotal;
+		if (mode.modeFlags & RR_DoubleScan)
+			verticalTotal *= 2.0;
+		if (mode.modeFlags & RR_Interlace)
+			verticalTotal /= 2.0;
+
+		return static_cast<double>(mode.dotClock) / (static_cast<double>(mode.hTotal) * verticalTotal);
+	}
+	return 0.0;
+}
+
+/******************************************************************************
+ * Gets the refresh rate of the monitor (CRTC) the middle of the supplied window
+ * is on, from the timings of its current XRandR mode. Without a window, or
+ * when the window is on none of them, the first active monitor is used, and
+ * the old per-screen rate of XRandR when the server has no CRTCs
  *****************************************************************************/
 int LinuxPlatform::getRefreshRate(const sf::WindowHandle& inHandle)
 {
-	UNUSED(inHandle);
-	return 59;
+	Display* display = XOpenDisplay(nullptr);
+	if (display == nullptr)
+		return kDefaultRefreshRate;
+
+	const Window root = DefaultRootWindow(display);
+	int centerX = -1;
+	int centerY = -1;
+	XWindowAttributes attributes;
+	if (inHandle != 0 && XGetWindowAttributes(display, inHandle, &attributes))
+	{
+		Window child;
+		XTranslateCoordinates(display, inHandle, root, attributes.width / 2, attributes.height / 2, &centerX, &centerY, &child);
+	}
+
+	double refreshRate = 0.0;
+	bool onWindow = false;
+	XRRScreenResources* resources = XRRGetScreenResourcesCurrent(display, root);
+	if (resources != nullptr)
+	{
+		for (int i = 0; i < resources->ncrtc && !onWindow; ++i)
+		{
+			XRRCrtcInfo* crtc = XRRGetCrtcInfo(display, resources, resources->crtcs[i]);
+			if (crtc == nullptr)
+				continue;
+
+			const bool contains = centerX >= crtc->x && centerX < crtc->x + static_cast<int>(crtc->width)
+				&& centerY >= crtc->y && centerY < crtc->y + static_cast<int>(crtc->height);
+			if (crtc->mode != None && (refreshRate == 0.0 || contains))
+			{
+				const double modeRate = getModeRefreshRate(resources, crtc->mode);
+				if (modeRate > 0.0)
+				{
+					refreshRate = modeRate;
+					onWindow = contains;
+				}
+			}
+			XRRFreeCrtcInfo(crtc);
+		}
+		XRRFreeScreenResources(resources);
+	}
+
+	if (refreshRate == 0.0)
+	{
+		XRRScreenConfiguration* config = XRRGetScreenInfo(display, root);
+		if (config != nullptr)
+		{
+			refreshRate = XRRConfigCurrentRate(config);
+			XRRFreeScreenConfigInfo(config);
+		}
+	}
+	XCloseDisplay(display);
+
+	return refreshRate > 0.0 ? static_cast<int>(std::lround(refreshRate)) : kDefaultRefreshRate;
 }
 }
 
@@ -13,6 +13,9 @@ struct LinuxPlatform : IPlatform
 	void toggleFullscreen(const sf::WindowHandle& inHandle, const sf::Uint32 inStyle, const bool inWindowed, const sf::Vector2u& inResolution) final;
 	float getScreenScalingFactor(const sf::WindowHandle& inHandle) final;
 	int getRefreshRate(const sf::WindowHandle& inHandle) final;
+
+private:
+	static constexpr int kDefaultRefreshRate = 60;
 };
 }
 
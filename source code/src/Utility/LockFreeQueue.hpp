@@ -0,0 +1,105 @@
+#ifndef UTIL_LOCK_FREE_QUEUE_HPP
+#define UTIL_LOCK_FREE_QUEUE_HPP
+
+namespace util
+{
+// Bounded multi-producer queue without locks (D. Vyukov's ring buffer).
+// Every cell carries a sequence number telling producers and consumers
+// whose turn it is, so a push or pop is a single compare-and-swap.
+template <typename T>
+class LockFreeQueue
+{
+public:
+	// inCapacity is rounded up to a power of two
+	explicit LockFreeQueue(const std::size_t inCapacity)
+	{
+		std::size_t capacity = 2;
+		while (capacity < inCapacity)
+			capacity *= 2;
+
+		m_cells = std::make_unique<Cell[]>(capacity);
+		m_mask = capacity - 1;
+		for (std::size_t i = 0; i < capacity; i++)
+			m_cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	LockFreeQueue(const LockFreeQueue&) = delete;
+	LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+	// returns false when the queue is full
+	bool push(const T& inValue)
+	{
+		Cell* cell;
+		std::size_t position = m_enqueue.load(std::memory_order_relaxed);
+		while (true)
+		{
+			cell = &m_cells[position & m_mask];
+			std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+			if (diff == 0)
+			{
+				if (m_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = m_enqueue.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->value = inValue;
+		cell->sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	// returns false when the queue is empty
+	bool pop(T& outValue)
+	{
+		Cell* cell;
+		std::size_t position = m_dequeue.load(std::memory_order_relaxed);
+		while (true)
+		{
+			cell = &m_cells[position & m_mask];
+			std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+			if (diff == 0)
+			{
+				if (m_dequeue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = m_dequeue.load(std::memory_order_relaxed);
+			}
+		}
+
+		outValue = cell->value;
+		cell->sequence.store(position + m_mask + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	struct Cell
+	{
+		std::atomic<std::size_t> sequence;
+		T value;
+	};
+
+	std::unique_ptr<Cell[]> m_cells;
+	std::size_t m_mask = 0;
+
+	// producers and the consumer work on separate cache lines
+	alignas(64) std::atomic<std::size_t> m_enqueue { 0 };
+	alignas(64) std::atomic<std::size_t> m_dequeue { 0 };
+};
+}
+
+#endif // UTIL_LOCK_FREE_QUEUE_HPP
@@ -0,0 +1,166 @@
+#include "Utility/ThreadPool.hpp"
+
+namespace util
+{
+/******************************************************************************
+ *
+ *****************************************************************************/
+ThreadPool::ThreadPool(const uint inThreadCount)
+{
+	uint count = inThreadCount;
+	if (count == 0)
+		count = std::max(std::thread::hardware_concurrency(), 1u);
+
+	for (uint i = 0; i < count; i++)
+		m_workers.push_back(std::make_unique<Worker>());
+
+	for (uint i = 0; i < count; i++)
+		m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+/******************************************************************************
+ * Tasks that are still queued are finished before the workers exit
+ *****************************************************************************/
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_stop = true;
+	}
+	m_wakeUp.notify_all();
+
+	for (std::thread& thread : m_threads)
+		thread.join();
+}
+
+/******************************************************************************
+ *
+ *****************************************************************************/
+void ThreadPool::submit(Task inTask)
+{
+	push(m_nextWorker++ % m_workers.size(), std::move(inTask));
+
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+	}
+	m_wakeUp.notify_one();
+}
+
+/******************************************************************************
+ * Runs inBody(0) ... inBody(inCount - 1) on the pool and returns once all of
+ * them are done. Each worker is seeded with a contiguous block of indices so
+ * neighbouring tiles stay on one core; idle workers steal the rest. The
+ * calling thread helps out instead of just sleeping.
+ *****************************************************************************/
+void ThreadPool::parallelFor(const uint inCount, const std::function<void(uint)>& inBody)
+{
+	if (inCount == 0)
+		return;
+
+	std::atomic<uint> remaining { inCount };
+	std::mutex doneMutex;
+	std::condition_variable done;
+
+	const ullong workers = m_workers.size();
+	for (uint i = 0; i < inCount; i++)
+	{
+		push(static_cast<uint>(i * workers / inCount), [&, i]() {
+			inBody(i);
+			std::lock_guard<std::mutex> lock(doneMutex);
+			if (--remaining == 0)
+				done.notify_all();
+		});
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+	}
+	m_wakeUp.notify_all();
+
+	Task task;
+	while (remaining > 0 && pop(0, task))
+		task();
+
+	std::unique_lock<std::mutex> lock(doneMutex);
+	done.wait(lock, [&]() {
+		return remaining == 0;
+	});
+}
+
+/******************************************************************************
+ *
+ *****************************************************************************/
+uint ThreadPool::getThreadCount() const
+{
+	return static_cast<uint>(m_threads.size());
+}
+
+/******************************************************************************
+ *
+ *****************************************************************************/
+void ThreadPool::push(const uint inWorker, Task inTask)
+{
+	Worker& worker = *m_workers[inWorker];
+	std::lock_guard<std::mutex> lock(worker.mutex);
+	worker.tasks.push_back(std::move(inTask));
+	m_queued++;
+}
+
+/******************************************************************************
+ * Own deque from the back first, then steal from the front of the others
+ *****************************************************************************/
+bool ThreadPool::pop(const uint inWorker, Task& outTask)
+{
+	{
+		Worker& own = *m_workers[inWorker];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty())
+		{
+			outTask = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			m_queued--;
+			return true;
+		}
+	}
+
+	const uint count = static_cast<uint>(m_workers.size());
+	for (uint i = 1; i < count; i++)
+	{
+		Worker& victim = *m_workers[(inWorker + i) % count];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty())
+		{
+			outTask = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			m_queued--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/******************************************************************************
+ *
+ *****************************************************************************/
+void ThreadPool::workerLoop(const uint inWorker)
+{
+	Task task;
+	while (true)
+	{
+		if (pop(inWorker, task))
+		{
+			task();
+			task = nullptr;
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_wakeUp.wait(lock, [this]() {
+			return m_stop || m_queued > 0;
+		});
+		if (m_stop && m_queued == 0)
+			return;
+	}
+}
+}
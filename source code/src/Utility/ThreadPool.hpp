@@ -0,0 +1,50 @@
+#ifndef UTIL_THREAD_POOL_HPP
+#define UTIL_THREAD_POOL_HPP
+
+#include <condition_variable>
+
+namespace util
+{
+// Persistent pool of worker threads. Every worker owns a deque of tasks: it
+// takes work from the back of its own deque and, when that runs dry, steals
+// from the front of the other workers' deques.
+class ThreadPool
+{
+public:
+	using Task = std::function<void()>;
+
+	// inThreadCount == 0 sizes the pool to the hardware
+	explicit ThreadPool(const uint inThreadCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void submit(Task inTask);
+	void parallelFor(const uint inCount, const std::function<void(uint)>& inBody);
+
+	uint getThreadCount() const;
+
+private:
+	struct Worker
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	void push(const uint inWorker, Task inTask);
+	bool pop(const uint inWorker, Task& outTask);
+	void workerLoop(const uint inWorker);
+
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_sleepMutex;
+	std::condition_variable m_wakeUp;
+	std::atomic<uint> m_queued { 0 };
+	std::atomic<uint> m_nextWorker { 0 };
+	bool m_stop = false;
+};
+}
+
+#endif // UTIL_THREAD_POOL_HPP
@@ -0,0 +1,96 @@
+#include <catch2/catch.hpp>
+
+#include "Fractal/Batch.hpp"
+
+static bool parse(const std::vector<std::string>& args, batch_image& image)
+{
+	std::string error;
+	return parse_batch_image(args, image, error);
+}
+
+TEST_CASE("batch options are read into the frame", "[batch]") {
+	batch_image image;
+	REQUIRE(parse({ "--render", "out.png", "--fractal", "burning_ship_julia", "--size", "320x200", "--view", "-1,0.5,1,-0.75",
+				"--iterations", "1000", "--julia", "-0.8,0.156", "--palette", "2", "--smooth", "--cache", "tiles" },
+		image));
+	REQUIRE(image.output == "out.png");
+	REQUIRE(image.frame.which_one == 3);
+	REQUIRE(image.frame.width == 320);
+	REQUIRE(image.frame.height == 200);
+	REQUIRE(image.frame.top_left.real == -1);
+	REQUIRE(image.frame.top_left.imag == 0.5);
+	REQUIRE(image.frame.bottom_right.real == 1);
+	REQUIRE(image.frame.bottom_right.imag == -0.75);
+	REQUIRE(image.frame.max_iterations == 1000);
+	REQUIRE(image.frame.julia_param.imag == 0.156);
+	REQUIRE(image.frame.colours.palette == 2);
+	REQUIRE(image.frame.colours.smooth);
+	REQUIRE(!image.frame.deep);
+
+	// a tiny pixel around a centre is a deep zoom
+	REQUIRE(parse({ "--render", "deep.ppm", "--center", "-0.75,0.1", "--pixel", "1e-20" }, image));
+	REQUIRE(image.frame.deep);
+	REQUIRE(image.frame.top_left.real == Approx(-0.75));
+	// the digits of the centre a double doesn't have are kept
+	REQUIRE(parse({ "--render", "deep.ppm", "--center", "-0.75000000000000000000013,0.1", "--pixel", "1e-25" }, image));
+	REQUIRE(big_to_double(big_sub(image.frame.view.center_real, big_from_double(-0.75, big_precision(image.frame.view.center_real)))) == Approx(-1.3e-22));
+	REQUIRE(!parse({ "--render", "a.png", "--center", "0,0,0", "--pixel", "1" }, image));
+
+	REQUIRE(!parse({ "--fractal", "julia" }, image));
+	REQUIRE(!parse({ "--render", "a.png", "--size", "320" }, image));
+	REQUIRE(!parse({ "--render", "a.png", "--size", "0x200" }, image));
+	REQUIRE(!parse({ "--render", "a.png", "--fractal", "4" }, image));
+	REQUIRE(!parse({ "--render", "a.png", "--center", "0,0" }, image));
+	REQUIRE(!parse({ "--render", "a.png", "--zoom", "2" }, image));
+	REQUIRE(!parse({ "--render", "a.png", "--iterations" }, image));
+
+	// one row of tiles of a poster 200000 pixels wide doesn't fit into the 512 megabytes
+	REQUIRE(!parse({ "--render", "wide.png", "--size", "200000x64" }, image));
+	REQUIRE(parse({ "--render", "wide.png", "--size", "200000x64", "--band-memory", "1024" }, image));
+	REQUIRE(image.poster);
+}
+
+// the image has the pixels of the framebuffer in rows and the ppm file has them without alpha
+TEST_CASE("headless render writes the frame into a ppm file", "[batch]") {
+	batch_image image;
+	REQUIRE(parse({ "--render", "unused.ppm", "--size", "150x97", "--fractal", "julia", "--julia", "-0.8,0.156" }, image));
+
+	util::ThreadPool pool(2);
+	std::vector<sf::Uint8> rgba;
+	REQUIRE(render_image(pool, image.frame, nullptr, rgba));
+	REQUIRE(rgba.size() == 150 * 97 * 4);
+
+	framebuffer target;
+	target.resize(150, 97);
+	std::shared_ptr<render_job> job = which(pool, target, image.frame);
+	while (!job->done() || target.busy > 0)
+		std::this_thread::yield();
+	for (uint y = 0; y < 97; y += 16)
+	{
+		for (uint x = 0; x < 150; x += 7)
+		{
+			uint tile = (y / tile_size) * target.tiles_x + x / tile_size;
+			sf::IntRect rect = target.tile_rect(tile);
+			const sf::Uint8* pixel = target.tile_pixels(tile) + 4 * ((y - rect.top) * rect.width + x - rect.left);
+			REQUIRE(std::equal(pixel, pixel + 4, &rgba[4 * (y * 150 + x)]));
+		}
+	}
+
+	util::fs::path path = util::fs::temp_directory_path() / "fractal_batch_test.ppm";
+	REQUIRE(save_image_file(path.string(), 150, 97, rgba));
+	std::ifstream file(path.string(), std::ios::binary);
+	std::string magic;
+	uint width, height, max;
+	file >> magic >> width >> height >> max;
+	file.get();
+	REQUIRE(magic == "P6");
+	REQUIRE(width == 150);
+	REQUIRE(height == 97);
+	REQUIRE(max == 255);
+	std::vector<char> pixels(150 * 97 * 3);
+	REQUIRE(file.read(pixels.data(), pixels.size()));
+	REQUIRE((sf::Uint8)pixels[3 * 151 + 2] == rgba[4 * 151 + 2]);
+	REQUIRE(file.peek() == EOF);
+	file.close();
+	util::fs::remove(path);
+}
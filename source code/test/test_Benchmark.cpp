@@ -0,0 +1,63 @@
+#include <catch2/catch.hpp>
+
+#include "Fractal/Benchmark.hpp"
+
+TEST_CASE("benchmark options are read", "[benchmark]") {
+	benchmark_options options;
+	std::string output;
+	std::string error;
+	REQUIRE(parse_benchmark_options({ "--benchmark", "out.json", "--sizes", "64,128", "--iterations", "100", "--threads", "1,3", "--repeats", "2" },
+		options, output, error));
+	REQUIRE(output == "out.json");
+	REQUIRE(options.sizes == std::vector<uint> { 64, 128 });
+	REQUIRE(options.iteration_caps == std::vector<uint> { 100 });
+	REQUIRE(options.thread_counts == std::vector<uint> { 1, 3 });
+	REQUIRE(options.repeats == 2);
+
+	REQUIRE(parse_benchmark_options({ "--quick", "--benchmark", "-" }, options, output, error));
+	REQUIRE(options.sizes == std::vector<uint> { 128 });
+	REQUIRE(options.repeats == 1);
+
+	REQUIRE(!parse_benchmark_options({ "--quick" }, options, output, error));
+	REQUIRE(!parse_benchmark_options({ "--benchmark", "a.json", "--sizes", "0" }, options, output, error));
+	REQUIRE(!parse_benchmark_options({ "--benchmark", "a.json", "--threads", "1,,2" }, options, output, error));
+	REQUIRE(!parse_benchmark_options({ "--benchmark", "a.json", "--size", "64" }, options, output, error));
+}
+
+// every kernel sees the same pixels, so all three ways add up to the same iterations
+TEST_CASE("benchmark measures every kernel on every view", "[benchmark]") {
+	benchmark_options options;
+	options.sizes = { 32 };
+	options.iteration_caps = { 64 };
+	options.thread_counts = { 1, 2 };
+	options.repeats = 1;
+
+	std::vector<benchmark_result> results = run_benchmarks(options);
+	REQUIRE(results.size() == benchmark_views.size() * 3 * 2);
+	for (size_t i = 0; i < results.size(); i += 3)
+	{
+		REQUIRE(results[i + 1].kernel == "row_kernel");
+		REQUIRE(results[i + 2].kernel == "generate");
+		for (size_t k = i; k < i + 3; k++)
+		{
+			REQUIRE(results[k].pixels == 32 * 32);
+			REQUIRE(results[k].seconds >= 0);
+			REQUIRE(results[k].iterations == results[i].iterations);
+		}
+		if (results[i].threads == 1)
+			REQUIRE(results[i].speedup == 1);
+	}
+	REQUIRE(results[0].kernel == "mendel_iter");
+	REQUIRE(results.back().kernel == "generate");
+
+	std::stringstream json;
+	write_benchmark_json(json, options, results);
+	const std::string text = json.str();
+	REQUIRE(text.front() == '{');
+	REQUIRE(text.find("\"results\": [") != std::string::npos);
+	REQUIRE(text.find("\"view\": \"seahorse_valley\", \"kernel\": \"burning_ship_iter\"") == std::string::npos);
+	REQUIRE(text.find("\"view\": \"burning_ship_antenna\", \"kernel\": \"burning_ship_iter\"") != std::string::npos);
+	REQUIRE(text.find("\"mpixels_per_second\"") != std::string::npos);
+	REQUIRE(std::count(text.begin(), text.end(), '{') == (long)results.size() + 1);
+	REQUIRE(std::count(text.begin(), text.end(), '{') == std::count(text.begin(), text.end(), '}'));
+}
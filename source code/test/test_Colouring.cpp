@@ -0,0 +1,109 @@
+#include <catch2/catch.hpp>
+
+#include "Fractal/Colouring.hpp"
+#include "Fractal/Kernels.hpp"
+
+// the default colouring has to give the colours the program always had
+TEST_CASE("classic palette keeps the old colours", "[colouring]") {
+	colouring colours;
+	for (uint iterations = 0; iterations < 1000; iterations++)
+	{
+		uint8_t colour = iterations;
+		sf::Color pixel = colour_palette(iterations, iterations == 1000, colours);
+		REQUIRE(pixel.r == colour);
+		REQUIRE(pixel.g == (uint8_t)(2 * colour));
+		REQUIRE(pixel.b == (uint8_t)(3 * colour));
+		REQUIRE(pixel.a == 255);
+	}
+}
+
+// along a line of points escaping later and later the smooth count has to go up
+// by much less than a whole iteration from one point to the next
+TEST_CASE("smooth iterations change continuously", "[colouring]") {
+	const uint max_iterations = 1000;
+	double previous = -1;
+
+	for (double real = 0.5; real > 0.3; real -= 0.00001)
+	{
+		complex pos = { real, 0 };
+		complex last_z;
+		uint iterations = mendel_iter(pos, max_iterations, &last_z);
+		REQUIRE(iterations < max_iterations);
+
+		double smooth = smooth_iterations(iterations, last_z, max_iterations);
+		REQUIRE(smooth >= iterations);
+		REQUIRE(smooth < iterations + 2);
+
+		if (previous >= 0)
+			REQUIRE(std::abs(smooth - previous) < 0.25);
+		previous = smooth;
+	}
+
+	// the pixels inside the set and the ones without a last z keep their count
+	REQUIRE(smooth_iterations(max_iterations, interior_z, max_iterations) == max_iterations);
+	REQUIRE(smooth_iterations(17, unknown_z, max_iterations) == 17);
+}
+
+// the lookup table and every colour kernel have to give the colours of colour_palette()
+// for the whole range of iterations, not only the first 256
+TEST_CASE("colour kernels match the palette", "[colouring]") {
+	const uint max_iterations = 5000;
+	const simd_level best = detect_simd_level();
+
+	// 203 pixels so the rows don't divide into whole vectors
+	std::vector<uint> iterations(203);
+	for (uint i = 0; i < iterations.size(); i++)
+		iterations[i] = i * 37 % (max_iterations + 100);
+
+	for (uint palette = 0; palette < palette_count; palette++)
+	{
+		colouring colours;
+		colours.palette = palette;
+		colours.contrast = 0.7;
+		colours.offset = 3;
+		palette_lut table = build_palette(colours, max_iterations);
+
+		for (int level = 0; level <= static_cast<int>(best); level++)
+		{
+			std::vector<sf::Uint8> pixels(4 * iterations.size());
+			select_colour_kernel(static_cast<simd_level>(level))(iterations.data(), iterations.size(), table, pixels.data());
+
+			for (uint i = 0; i < iterations.size(); i++)
+			{
+				sf::Color expected = colour_palette(std::min(iterations[i], max_iterations), iterations[i] >= max_iterations, colours);
+				REQUIRE(pixels[4 * i] == expected.r);
+				REQUIRE(pixels[4 * i + 1] == expected.g);
+				REQUIRE(pixels[4 * i + 2] == expected.b);
+				REQUIRE(pixels[4 * i + 3] == expected.a);
+			}
+		}
+	}
+}
+
+// the frames with the same colours share one palette, a new one is only built for different colours
+// and a palette a frame still uses is never built over
+TEST_CASE("palette cache reuses the palette of the last frame", "[colouring]") {
+	palette_cache palettes;
+	colouring colours;
+	colours.palette = 1;
+
+	std::shared_ptr<const palette_lut> first = palettes.get(colours, 300);
+	REQUIRE(palettes.get(colours, 300) == first);
+	REQUIRE(first->colours == build_palette(colours, 300).colours);
+
+	colours.offset = 5;
+	std::shared_ptr<const palette_lut> second = palettes.get(colours, 300);
+	REQUIRE(second != first);
+	REQUIRE(first->colours == build_palette(colouring { 1, false, 1, 0 }, 300).colours);
+	REQUIRE(second->colours == build_palette(colours, 300).colours);
+
+	// nothing holds the second one anymore, the next one is built into its memory
+	const palette_lut* storage = second.get();
+	const uint32_t* table = second->colours.data();
+	second.reset();
+	std::shared_ptr<const palette_lut> third = palettes.get(colours, 200);
+	REQUIRE(third.get() == storage);
+	REQUIRE(third->colours.data() == table);
+	REQUIRE(third->colours == build_palette(colours, 200).colours);
+	REQUIRE(third->max_iterations == 200);
+}
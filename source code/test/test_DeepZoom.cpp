@@ -0,0 +1,126 @@
+#include <catch2/catch.hpp>
+
+#include "Fractal/BigFixed.hpp"
+#include "Fractal/DeepZoom.hpp"
+#include "Fractal/Kernels.hpp"
+
+TEST_CASE("big_fixed arithmetic", "[deepzoom]") {
+	REQUIRE(big_to_double(big_from_double(-1.625, 2)) == -1.625);
+	REQUIRE(big_to_double(big_add(big_from_double(1.5, 2), big_from_double(-2.25, 2))) == -0.75);
+	REQUIRE(big_to_double(big_sub(big_from_double(0.5, 2), big_from_double(0.5, 2))) == 0);
+	REQUIRE(big_to_double(big_mul(big_from_double(1.5, 2), big_from_double(-2.25, 2))) == -3.375);
+
+	// far more bits than a double has
+	big_fixed tiny = big_from_double(std::ldexp(1, -100), 4);
+	big_fixed one = big_from_double(1, 4);
+	REQUIRE(big_to_double(big_sub(big_add(one, tiny), one)) == std::ldexp(1, -100));
+}
+
+// the text keeps digits a double can't, they have to end up in the limbs
+TEST_CASE("big_fixed is read from decimal text", "[deepzoom]") {
+	big_fixed a;
+	REQUIRE(big_from_string("-1.625", 2, a));
+	REQUIRE(big_to_double(a) == -1.625);
+	REQUIRE(big_from_string("25e-2", 2, a));
+	REQUIRE(big_to_double(a) == 0.25);
+	REQUIRE(big_from_string("+3", 1, a));
+	REQUIRE(big_to_double(a) == 3);
+	REQUIRE(big_from_string("0.1", 3, a));
+	REQUIRE(big_to_double(a) == Approx(0.1));
+
+	// 1 + 2^-100 written out in decimals
+	REQUIRE(big_from_string("1.0000000000000000000000000000007888609052210118054117285652827862296732064351090230047702789306640625", 4, a));
+	REQUIRE(big_to_double(big_sub(a, big_from_double(1, 4))) == std::ldexp(1, -100));
+	// the same digits past 1e-30 as the deep zoom centres of the batch
+	big_fixed b;
+	REQUIRE(big_from_string("-0.7500000000000000000000000000013", 4, a));
+	REQUIRE(big_from_string("-0.75", 4, b));
+	REQUIRE(big_to_double(big_sub(a, b)) == Approx(-1.3e-30));
+
+	REQUIRE(!big_from_string("", 2, a));
+	REQUIRE(!big_from_string("-", 2, a));
+	REQUIRE(!big_from_string("1.5x", 2, a));
+	REQUIRE(!big_from_string("1e", 2, a));
+	REQUIRE(!big_from_string("1.2.3", 2, a));
+	REQUIRE(!big_from_string("5000000000", 2, a));
+}
+
+TEST_CASE("moving a deep view keeps its precision", "[deepzoom]") {
+	deep_view view;
+	view.center_real = big_from_double(-0.75, 1);
+	view.center_imag = big_from_double(0.1, 1);
+	view.pixel.real = 1e-120;
+	view.pixel.imag = 1e-120;
+
+	deep_view moved = view;
+	move_view(moved, 3, -5);
+	REQUIRE(big_to_double(big_sub(moved.center_real, view.center_real)) == Approx(3e-120));
+	REQUIRE(big_to_double(big_sub(moved.center_imag, view.center_imag)) == Approx(5e-120));
+
+	move_view(moved, -3, 5);
+	REQUIRE(big_to_double(big_sub(moved.center_real, view.center_real)) == Approx(0).margin(1e-125));
+	REQUIRE(needs_deep_zoom(moved));
+}
+
+// at a zoom doubles can still handle the perturbation has to agree with iterating the pixels directly
+TEST_CASE("perturbation matches the direct kernel", "[deepzoom]") {
+	const uint max_iterations = 500;
+	big_fixed center_real = big_from_double(-0.75, 3);
+	big_fixed center_imag = big_from_double(0.1, 3);
+	std::vector<complex> reference = reference_orbit(center_real, center_imag, max_iterations);
+
+	row_job job;
+	job.step = 0.004;
+	job.origin_real = -100 * job.step;
+	job.x_begin = 0;
+	job.count = 200;
+	job.max_iterations = max_iterations;
+	job.reference = reference.data();
+	job.reference_length = (uint)reference.size();
+
+	uint same = 0;
+	uint total = 0;
+	for (int y = -100; y < 100; y += 5)
+	{
+		job.imag = y * job.step;
+		uint iterations[200];
+		perturbation_row(job, iterations);
+
+		for (uint x = 0; x < job.count; x++)
+		{
+			complex c;
+			c.real = -0.75 + job.origin_real + x * job.step;
+			c.imag = 0.1 + job.imag;
+			uint expected = mendel_iter(c, max_iterations);
+			same += iterations[x] == expected;
+			total++;
+		}
+	}
+	REQUIRE(same >= total * 99 / 100);
+}
+
+// the needle tip: the reference just outside radius 2 escapes at the first step, the orbit has only Z_0 and Z_1
+TEST_CASE("perturbation around a reference that escapes right away", "[deepzoom]") {
+	const uint max_iterations = 100;
+	std::vector<complex> reference = reference_orbit(big_from_double(-2.0000001, 3), big_from_double(0, 3), max_iterations);
+	REQUIRE(reference.size() == 2);
+
+	row_job job;
+	job.step = 1e-6;
+	job.origin_real = 1e-7;
+	job.x_begin = 0;
+	job.count = 5;
+	job.stride = 1;
+	job.imag = 0;
+	job.max_iterations = max_iterations;
+	job.reference = reference.data();
+	job.reference_length = (uint)reference.size();
+
+	uint iterations[5];
+	perturbation_row(job, iterations);
+	for (uint x = 0; x < job.count; x++)
+	{
+		complex c = { -2.0000001 + job.origin_real + x * job.step, 0 };
+		REQUIRE(iterations[x] == mendel_iter(c, max_iterations));
+	}
+}
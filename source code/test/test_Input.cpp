@@ -0,0 +1,244 @@
+#include <catch2/catch.hpp>
+
+#include "Fractal/Input.hpp"
+
+static explorer_state starting_state()
+{
+	explorer_state state;
+	reset_view(state.view, state.top_left, state.bottom_right, state.width, state.height, state.zoomlvl);
+	return state;
+}
+
+TEST_CASE("inputs are written and read back exactly", "[input]") {
+	input_event wheel;
+	wheel.time = 1.25;
+	wheel.kind = input_kind::wheel;
+	wheel.delta = 0.1234567891234;
+	wheel.x = 17;
+	wheel.y = -3;
+
+	input_event resize;
+	resize.time = 2;
+	resize.kind = input_kind::resize;
+	resize.x = 1024;
+	resize.y = 700;
+	resize.move_x = 112;
+	resize.move_y = -50.5;
+
+	input_event key;
+	key.kind = input_kind::key;
+	key.value = sf::Keyboard::Add;
+
+	for (const input_event& input : { wheel, resize, key })
+	{
+		input_event read;
+		REQUIRE(parse_input(format_input(input), read));
+		REQUIRE(read.time == input.time);
+		REQUIRE(read.kind == input.kind);
+		REQUIRE(read.x == input.x);
+		REQUIRE(read.y == input.y);
+		REQUIRE(read.delta == input.delta);
+		REQUIRE(read.move_x == input.move_x);
+		REQUIRE(read.move_y == input.move_y);
+		REQUIRE(read.value == input.value);
+	}
+	REQUIRE(format_input(wheel) == "1.250000 wheel 0.1234567891234 17 -3");
+
+	input_event read;
+	REQUIRE(!parse_input("", read));
+	REQUIRE(!parse_input("1.0 jump 3", read));
+	REQUIRE(!parse_input("1.0 pan 3", read));
+	REQUIRE(!parse_input("1.0 fractal 2 4", read));
+}
+
+// the same inputs on the same state always end in the same view
+TEST_CASE("inputs change the state the way the window does", "[input]") {
+	explorer_state state = starting_state();
+
+	input_event input;
+	input.kind = input_kind::wheel;
+	input.delta = 1;
+	input.x = 400;
+	input.y = 400;
+	REQUIRE(apply_input(state, input).update);
+	REQUIRE(state.zoomlvl == Approx(1.1));
+	REQUIRE(state.top_left.real == Approx(-2 / 1.1));
+	// a grid the wheel zoomed to isn't met again, its tiles aren't kept
+	REQUIRE(state_frame(starting_state()).recurring);
+	REQUIRE(!state_frame(state).recurring);
+
+	// with grid zooming on the wheel zooms 2x
+	input.kind = input_kind::key;
+	input.value = sf::Keyboard::Z;
+	REQUIRE(!apply_input(state, input).update);
+	input.kind = input_kind::wheel;
+	input.delta = -1;
+	apply_input(state, input);
+	REQUIRE(state.zoomlvl == Approx(1.1 / 2));
+
+	input.kind = input_kind::key;
+	input.value = sf::Keyboard::R;
+	REQUIRE(apply_input(state, input).update);
+	REQUIRE(state.zoomlvl == 1);
+	REQUIRE(state.top_left.real == -2);
+	// the 2x grid zoom (still on) stays on the grids of the starting view
+	input.kind = input_kind::wheel;
+	input.delta = 2;
+	apply_input(state, input);
+	REQUIRE(state.zoomlvl == 4);
+	REQUIRE(state_frame(state).recurring);
+	input.kind = input_kind::key;
+	input.value = sf::Keyboard::R;
+	apply_input(state, input);
+
+	input.value = sf::Keyboard::Equal;
+	apply_input(state, input);
+	REQUIRE(state.max_iterations == 510);
+	input.value = sf::Keyboard::P;
+	input_effect effect = apply_input(state, input);
+	REQUIRE((effect.recolour && !effect.update));
+	REQUIRE(state.colours.palette == 1);
+
+	// the julia parameter only renders again when a julia fractal is displayed
+	input.kind = input_kind::julia;
+	input.x = 0;
+	input.y = 800;
+	REQUIRE(!apply_input(state, input).update);
+	REQUIRE(state.julia_param.real == -2);
+	REQUIRE(state.julia_param.imag == -2);
+	input.kind = input_kind::fractal;
+	input.value = 3;
+	apply_input(state, input);
+	input.kind = input_kind::julia;
+	REQUIRE(apply_input(state, input).update);
+
+	input.kind = input_kind::pan;
+	input.x = 100;
+	input.y = 0;
+	apply_input(state, input);
+	REQUIRE(state.top_left.real == Approx(-1.5));
+
+	// the middle moves by half of the growth when the right wall is dragged
+	input.kind = input_kind::resize;
+	input.x = 1000;
+	input.y = 800;
+	input.move_x = 100;
+	input.move_y = 0;
+	effect = apply_input(state, input);
+	REQUIRE(effect.resized);
+	REQUIRE(state.width == 1000);
+	REQUIRE(state.top_left.real == Approx(-1.5));
+	REQUIRE(state.bottom_right.real == Approx(3.5));
+
+	frame_params frame = state_frame(state);
+	REQUIRE(frame.width == 1000);
+	REQUIRE(frame.which_one == 3);
+	REQUIRE(frame.max_iterations == 510);
+	REQUIRE(frame.progressive);
+}
+
+TEST_CASE("cancelled frames pass their inputs on to the next frame", "[input]") {
+	latency_tracker latency;
+	latency.input(1);
+	latency.input(1.5);
+	latency.frame_started(1.6, false);
+	latency.input(2);
+	latency.frame_started(2.1, true); // the first frame is cancelled, the second one shows the input of 1 as well
+	latency.frame_done(3);
+	latency.frame_started(4, false); // without an input, colours changed ...
+	latency.frame_done(4.25);
+	REQUIRE(latency.latencies.size() == 2);
+	REQUIRE(latency.latencies[0] == 2);
+	REQUIRE(latency.latencies[1] == 0.25);
+
+	std::vector<double> times;
+	for (int i = 100; i >= 1; i--)
+		times.push_back(i / 1000.);
+	percentiles result = time_percentiles(times);
+	REQUIRE(result.count == 100);
+	REQUIRE(result.p50 == 0.05);
+	REQUIRE(result.p95 == 0.095);
+	REQUIRE(result.p99 == 0.099);
+	REQUIRE(result.max == 0.1);
+	REQUIRE(time_percentiles({ 0.5 }).p99 == 0.5);
+	REQUIRE(time_percentiles({}).count == 0);
+}
+
+TEST_CASE("headless replay renders every recorded input", "[input]") {
+	std::vector<input_event> inputs;
+	input_event input;
+	input.kind = input_kind::wheel;
+	input.delta = 1;
+	input.x = 300;
+	input.y = 500;
+	for (int i = 0; i < 3; i++)
+	{
+		input.time = 0.01 * i;
+		inputs.push_back(input);
+	}
+	input.time = 0.05;
+	input.kind = input_kind::key;
+	input.value = sf::Keyboard::Hyphen;
+	inputs.push_back(input);
+
+	util::ThreadPool pool(2);
+	tile_cache cache;
+	latency_tracker latency;
+	uint frames = replay_headless(inputs, pool, &cache, latency);
+	REQUIRE(frames >= 2);
+	REQUIRE(frames <= 5);
+	REQUIRE(!latency.latencies.empty());
+	for (double seconds : latency.latencies)
+		REQUIRE(seconds >= 0);
+}
+
+// a burst of the wheel is one zoom by the sum of its turns, at the last place of the cursor
+TEST_CASE("wheel bursts are folded into one zoom", "[input]") {
+	std::vector<input_event> inputs;
+	input_event input;
+	input.kind = input_kind::wheel;
+	for (int i = 0; i < 30; i++)
+	{
+		input.delta = 0.25;
+		input.x = 400 + i;
+		input.y = 400;
+		inputs.push_back(input);
+	}
+	input_event key;
+	key.kind = input_kind::key;
+	key.value = sf::Keyboard::Add;
+	inputs.push_back(key);
+	input.delta = -1;
+	inputs.push_back(input);
+	inputs.push_back(input);
+
+	coalesce_wheel(inputs);
+	REQUIRE(inputs.size() == 3);
+	REQUIRE(inputs[0].delta == 7.5);
+	REQUIRE(inputs[0].x == 429);
+	REQUIRE(inputs[1].kind == input_kind::key);
+	REQUIRE(inputs[2].delta == -2);
+
+	// the zoom follows the delta, not only its sign
+	explorer_state state = starting_state();
+	input.x = 400;
+	input.delta = 7.5;
+	REQUIRE(apply_input(state, input).update);
+	REQUIRE(state.zoomlvl == Approx(std::pow(1.1, 7.5)));
+	input.delta = -0.5;
+	apply_input(state, input);
+	REQUIRE(state.zoomlvl == Approx(std::pow(1.1, 7)));
+	input.delta = 0;
+	REQUIRE(!apply_input(state, input).update);
+
+	// on the grid every whole notch is a 2x step
+	state = starting_state();
+	state.grid_zooming = true;
+	input.delta = 3;
+	input.x = 600;
+	input.y = 200;
+	apply_input(state, input);
+	REQUIRE(state.zoomlvl == 8);
+	REQUIRE(state.top_left.real + state.bottom_right.real == Approx(2 * 1.0));
+	REQUIRE(state.top_left.imag + state.bottom_right.imag == Approx(2 * 1.0));
+}
@@ -0,0 +1,114 @@
+#include <catch2/catch.hpp>
+
+#include "Fractal/Kernels.hpp"
+#include "Fractal/SimdKernels.hpp"
+
+// every instruction set the processor supports has to give the same iterations as the scalar functions
+TEST_CASE("row kernels match the scalar kernels", "[kernels]") {
+	const row_kernels& scalar = select_row_kernels(simd_level::scalar);
+	const simd_level best = detect_simd_level();
+
+	complex point;
+	point.real = -0.8;
+	point.imag = 0.156;
+
+	for (int level = 0; level <= static_cast<int>(best); level++)
+	{
+		const row_kernels& kernels = select_row_kernels(static_cast<simd_level>(level));
+		REQUIRE(static_cast<int>(kernels.level) == level);
+
+		const row_kernel pairs[4][2] = {
+			{ scalar.mandelbrot, kernels.mandelbrot },
+			{ scalar.mandelbrot_julia, kernels.mandelbrot_julia },
+			{ scalar.burning_ship, kernels.burning_ship },
+			{ scalar.burning_ship_julia, kernels.burning_ship_julia }
+		};
+
+		for (const auto& pair : pairs)
+		{
+			// 203 pixels so the rows don't divide into whole vectors
+			for (uint y = 0; y < 203; y += 7)
+			{
+				row_job job;
+				job.origin_real = -2.0;
+				job.step = 4.0 / 203;
+				job.imag = 2.0 - y * (4.0 / 203);
+				job.x_begin = 3;
+				job.count = 200;
+				job.max_iterations = 500;
+				job.point = point;
+
+				uint expected[200];
+				uint actual[200];
+				pair[0](job, expected);
+				pair[1](job, actual);
+
+				for (uint x = 0; x < 200; x++)
+					REQUIRE(expected[x] == actual[x]);
+			}
+		}
+	}
+}
+
+TEST_CASE("scalar row kernel matches the per pixel functions", "[kernels]") {
+	const row_kernels& scalar = select_row_kernels(simd_level::scalar);
+
+	row_job job;
+	job.origin_real = -2.0;
+	job.step = 0.01;
+	job.imag = 0.5;
+	job.x_begin = 10;
+	job.count = 64;
+	job.max_iterations = 255;
+	job.point.real = 0;
+	job.point.imag = 0;
+
+	uint iterations[64];
+	scalar.mandelbrot(job, iterations);
+
+	for (uint i = 0; i < 64; i++)
+	{
+		complex pos;
+		pos.real = job.origin_real + (job.x_begin + i) * job.step;
+		pos.imag = job.imag;
+		REQUIRE(iterations[i] == mendel_iter(pos, 255));
+	}
+}
+
+// plain escape time loop without any shortcuts
+static uint brute_force_iter(complex pos, uint max_iterations, bool julia, bool burning, complex point)
+{
+	complex c = julia ? point : pos;
+	uint iter = 0;
+	while (pos.real * pos.real + pos.imag * pos.imag < 4 && iter < max_iterations)
+	{
+		double temp = pos.real * pos.real - pos.imag * pos.imag + c.real;
+		pos.imag = burning ? 2 * std::abs(pos.real) * std::abs(pos.imag) + c.imag : 2 * pos.real * pos.imag + c.imag;
+		pos.real = temp;
+		iter++;
+	}
+	return iter;
+}
+
+// the cardioid/bulb test and the periodicity check may only end points that would never escape
+TEST_CASE("interior shortcuts give the same iterations as brute force", "[kernels]") {
+	const uint max_iterations = 2000;
+	complex point;
+	point.real = -0.12;
+	point.imag = 0.75;
+
+	for (int y = 0; y < 60; y++)
+	{
+		for (int x = 0; x < 60; x++)
+		{
+			complex pos;
+			pos.real = -2.0 + x * (2.5 / 60);
+			pos.imag = -1.25 + y * (2.5 / 60);
+
+			REQUIRE(mendel_iter(pos, max_iterations) == brute_force_iter(pos, max_iterations, false, false, point));
+			REQUIRE(mandelbrot_julia_iter(pos, max_iterations, point) == brute_force_iter(pos, max_iterations, true, false, point));
+			REQUIRE(burning_ship_iter(pos, max_iterations) == brute_force_iter(pos, max_iterations, false, true, point));
+			REQUIRE(burning_ship_julia_iter(pos, max_iterations, point) == brute_force_iter(pos, max_iterations, true, true, point));
+		}
+	}
+}
@@ -0,0 +1,52 @@
+#include <catch2/catch.hpp>
+
+#include "Utility/LockFreeQueue.hpp"
+
+TEST_CASE("util::LockFreeQueue", "[lockfreequeue]") {
+	util::LockFreeQueue<uint> queue(5);
+	uint value;
+
+	REQUIRE_FALSE(queue.pop(value));
+
+	// the capacity is rounded up to 8
+	for (uint i = 0; i < 8; i++)
+		REQUIRE(queue.push(i));
+	REQUIRE_FALSE(queue.push(8));
+
+	for (uint i = 0; i < 8; i++)
+	{
+		REQUIRE(queue.pop(value));
+		REQUIRE(value == i);
+	}
+	REQUIRE_FALSE(queue.pop(value));
+}
+
+TEST_CASE("util::LockFreeQueue with several producers", "[lockfreequeue]") {
+	util::LockFreeQueue<uint> queue(4000);
+
+	std::vector<std::thread> producers;
+	for (uint p = 0; p < 4; p++)
+		producers.emplace_back([&queue, p]() {
+			for (uint i = 0; i < 1000; i++)
+				queue.push(p * 1000 + i);
+		});
+
+	// every value has to come out exactly once
+	std::vector<uint> seen(4000, 0);
+	uint received = 0;
+	uint value;
+	while (received < 4000)
+	{
+		if (queue.pop(value))
+		{
+			seen[value]++;
+			received++;
+		}
+	}
+
+	for (std::thread& producer : producers)
+		producer.join();
+
+	for (uint count : seen)
+		REQUIRE(count == 1);
+}
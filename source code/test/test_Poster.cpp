@@ -0,0 +1,243 @@
+#include <catch2/catch.hpp>
+
+#include "Fractal/Batch.hpp"
+
+// keeps the rows it is given, in place of a file
+class memory_writer : public image_writer
+{
+public:
+	std::vector<sf::Uint8> rgba;
+	std::vector<uint> calls;
+	bool finished = false;
+
+	bool write_rows(const sf::Uint8* rows, uint count) override
+	{
+		rgba.insert(rgba.end(), rows, rows + 4 * 200 * count);
+		calls.push_back(count);
+		return true;
+	}
+	bool finish() override
+	{
+		finished = true;
+		return true;
+	}
+};
+
+static std::vector<sf::Uint8> read_file(const util::fs::path& path)
+{
+	std::ifstream file(path.string(), std::ios::binary);
+	return std::vector<sf::Uint8>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static uint big_endian(const sf::Uint8* bytes)
+{
+	return (uint)bytes[0] << 24 | (uint)bytes[1] << 16 | (uint)bytes[2] << 8 | bytes[3];
+}
+
+static ullong little_endian(const sf::Uint8* bytes, uint count)
+{
+	ullong value = 0;
+	for (uint i = count; i-- > 0;)
+		value = value << 8 | bytes[i];
+	return value;
+}
+
+// with a view whose pixels are powers of 2 the bands have exactly the pixels of the whole image
+TEST_CASE("poster bands give the same picture as the whole frame", "[poster]") {
+	batch_image image;
+	std::string error;
+	REQUIRE(parse_batch_image({ "--render", "poster.png", "--size", "200x300", "--center", "-0.5,0.25", "--pixel", "0.0078125" }, image, error));
+
+	util::ThreadPool pool(4);
+	std::vector<sf::Uint8> whole;
+	REQUIRE(render_image(pool, image.frame, nullptr, whole));
+
+	// a band of 64 rows
+	size_t band_memory = poster_memory(200, 64);
+	REQUIRE(band_memory == 64 * 200 * 52 + poster_writer_bytes(200));
+	REQUIRE(poster_band_height(200, 300, band_memory) == 64);
+	// the memory of the writer comes off the bands
+	REQUIRE(poster_band_height(200, 300, 128 * 200 * 52 + poster_writer_bytes(200)) == 128);
+	REQUIRE(poster_band_height(200, 300, 192 * 200 * 52) == 64);
+	// not even one row of tiles fits, the memory isn't exceeded
+	REQUIRE(poster_band_height(200, 300, band_memory - 1) == 0);
+	memory_writer small;
+	REQUIRE(!render_poster(pool, image.frame, nullptr, small, band_memory - 1));
+	REQUIRE(small.calls.empty());
+	memory_writer writer;
+	REQUIRE(render_poster(pool, image.frame, nullptr, writer, band_memory));
+	REQUIRE(writer.finished);
+	REQUIRE(writer.calls == std::vector<uint> { 64, 64, 64, 64, 44 });
+	REQUIRE(writer.rgba == whole);
+}
+
+// decoding the png by hand: the chunks, their crc, the stored deflate blocks and the adler-32 of the rows
+TEST_CASE("streamed png holds the rows", "[poster]") {
+	const uint width = 70;
+	const uint height = 1000; // more than one stored block
+	std::vector<sf::Uint8> rgba(4 * width * height);
+	for (size_t i = 0; i < rgba.size(); i++)
+		rgba[i] = (sf::Uint8)(i * 7 + i / 13);
+
+	util::fs::path path = util::fs::temp_directory_path() / "fractal_poster_test.png";
+	{
+		std::unique_ptr<image_writer> writer = open_image_writer(path.string(), width, height);
+		REQUIRE(writer);
+		REQUIRE(writer->write_rows(rgba.data(), 300));
+		REQUIRE(writer->write_rows(rgba.data() + 4 * width * 300, 700));
+		REQUIRE(writer->finish());
+	}
+	std::vector<sf::Uint8> file = read_file(path);
+	util::fs::remove(path);
+
+	const sf::Uint8 signature[8] = { 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+	REQUIRE(std::equal(signature, signature + 8, file.begin()));
+
+	std::vector<sf::Uint8> stream;
+	size_t at = 8;
+	std::string last;
+	while (at < file.size())
+	{
+		uint length = big_endian(&file[at]);
+		std::string type(file.begin() + at + 4, file.begin() + at + 8);
+		REQUIRE(at + 12 + length <= file.size());
+		if (type == "IHDR")
+		{
+			REQUIRE(big_endian(&file[at + 8]) == width);
+			REQUIRE(big_endian(&file[at + 12]) == height);
+		}
+		if (type == "IDAT")
+			stream.insert(stream.end(), file.begin() + at + 8, file.begin() + at + 8 + length);
+
+		// crc of the type and the data
+		uint crc = 0xffffffff;
+		for (size_t i = at + 4; i < at + 8 + length; i++)
+		{
+			crc ^= file[i];
+			for (uint k = 0; k < 8; k++)
+				crc = crc & 1 ? 0xedb88320u ^ (crc >> 1) : crc >> 1;
+		}
+		REQUIRE(~crc == big_endian(&file[at + 8 + length]));
+		at += 12 + length;
+		last = type;
+	}
+	REQUIRE(last == "IEND");
+
+	REQUIRE(stream[0] == 0x78);
+	std::vector<sf::Uint8> raw;
+	at = 2;
+	bool final = false;
+	while (!final)
+	{
+		final = stream[at] & 1;
+		REQUIRE((stream[at] & 6) == 0);
+		uint length = stream[at + 1] | stream[at + 2] << 8;
+		uint complement = stream[at + 3] | stream[at + 4] << 8;
+		REQUIRE((length ^ complement) == 0xffff);
+		raw.insert(raw.end(), stream.begin() + at + 5, stream.begin() + at + 5 + length);
+		at += 5 + length;
+	}
+	REQUIRE(at + 4 == stream.size());
+
+	uint a = 1, b = 0;
+	for (sf::Uint8 byte : raw)
+	{
+		a = (a + byte) % 65521;
+		b = (b + a) % 65521;
+	}
+	REQUIRE(big_endian(&stream[at]) == (b << 16 | a));
+
+	REQUIRE(raw.size() == (size_t)height * (1 + 3 * width));
+	for (uint y = 0; y < height; y += 37)
+	{
+		const sf::Uint8* row = &raw[y * (1 + 3 * width)];
+		REQUIRE(row[0] == 0);
+		for (uint x = 0; x < width; x++)
+		{
+			for (uint c = 0; c < 3; c++)
+				REQUIRE(row[1 + 3 * x + c] == rgba[4 * (y * width + x) + c]);
+		}
+	}
+}
+
+// a band of a big image is cut into many IDAT chunks, none of them anywhere near the limit of a png chunk
+TEST_CASE("streamed png splits the rows into bounded chunks", "[poster]") {
+	const uint width = 1000;
+	const uint height = 1200;
+	std::vector<sf::Uint8> rgba(4 * (size_t)width * height, 200);
+
+	util::fs::path path = util::fs::temp_directory_path() / "fractal_poster_chunks_test.png";
+	{
+		std::unique_ptr<image_writer> writer = open_image_writer(path.string(), width, height);
+		REQUIRE(writer);
+		REQUIRE(writer->write_rows(rgba.data(), height));
+		REQUIRE(writer->finish());
+	}
+	std::vector<sf::Uint8> file = read_file(path);
+	util::fs::remove(path);
+
+	uint chunks = 0;
+	size_t data = 0;
+	for (size_t at = 8; at < file.size();)
+	{
+		uint length = big_endian(&file[at]);
+		if (std::string(file.begin() + at + 4, file.begin() + at + 8) == "IDAT")
+		{
+			chunks++;
+			data += length;
+			REQUIRE(length <= (1 << 20) + 65540);
+		}
+		at += 12 + length;
+	}
+	REQUIRE(chunks >= 3);
+	REQUIRE(data > (size_t)height * (1 + 3 * width));
+}
+
+// reading the tags of the tiff back and finding a row through its strip
+TEST_CASE("streamed tiff holds the rows", "[poster]") {
+	const uint width = 33;
+	const uint height = 20;
+	std::vector<sf::Uint8> rgba(4 * width * height);
+	for (size_t i = 0; i < rgba.size(); i++)
+		rgba[i] = (sf::Uint8)(i * 5 + 1);
+
+	util::fs::path path = util::fs::temp_directory_path() / "fractal_poster_test.tif";
+	{
+		std::unique_ptr<image_writer> writer = open_image_writer(path.string(), width, height);
+		REQUIRE(writer);
+		REQUIRE(writer->write_rows(rgba.data(), height));
+		REQUIRE(writer->finish());
+	}
+	std::vector<sf::Uint8> file = read_file(path);
+	util::fs::remove(path);
+
+	REQUIRE(file[0] == 'I');
+	REQUIRE(little_endian(&file[2], 2) == 42);
+	size_t directory = little_endian(&file[4], 4);
+	uint entries = little_endian(&file[directory], 2);
+	REQUIRE(entries == 10);
+
+	std::map<uint, std::pair<ullong, ullong>> tags; // count and value
+	for (uint i = 0; i < entries; i++)
+	{
+		const sf::Uint8* entry = &file[directory + 2 + 12 * i];
+		tags[little_endian(entry, 2)] = { little_endian(entry + 4, 4), little_endian(entry + 8, 4) };
+	}
+	REQUIRE(tags[256].second == width);
+	REQUIRE(tags[257].second == height);
+	REQUIRE(tags[277].second == 3);
+	REQUIRE(tags[278].second == 1);
+	REQUIRE(tags[273].first == height);
+	size_t bits = tags[258].second;
+	REQUIRE(little_endian(&file[bits], 2) == 8);
+	REQUIRE(little_endian(&file[bits + 4], 2) == 8);
+
+	uint y = 13;
+	size_t strip = little_endian(&file[tags[273].second + 4 * y], 4);
+	REQUIRE(little_endian(&file[tags[279].second + 4 * y], 4) == 3 * width);
+	for (uint x = 0; x < width; x++)
+	{
+		for (uint c = 0; c < 3; c++)
+			REQUIRE(file[strip + 3 * x + c] == rgba[4 * (y * width + x) + c]);
+	}
+}
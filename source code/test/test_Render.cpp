@@ -0,0 +1,673 @@
+#include <catch2/catch.hpp>
+
+#include "Fractal/Render.hpp"
+
+static std::vector<sf::Uint8> render_and_wait(util::ThreadPool& pool, const frame_params& frame)
+{
+	framebuffer target;
+	target.resize(frame.width, frame.height);
+
+	std::shared_ptr<render_job> job = which(pool, target, frame);
+	while (!job->done())
+		std::this_thread::yield();
+
+	finished_tile tile;
+	uint finished = 0;
+	while (target.finished->pop(tile))
+		finished++;
+	REQUIRE(finished == target.tile_count());
+
+	return target.pixels;
+}
+
+// the frame has to be the same no matter how many threads render it
+TEST_CASE("render is independent of the thread count", "[render]") {
+	frame_params frame;
+	frame.width = 203;
+	frame.height = 150;
+	frame.top_left.real = -2;
+	frame.top_left.imag = 1.5;
+	frame.bottom_right.real = 1;
+	frame.bottom_right.imag = -1.5;
+	frame.max_iterations = 255;
+	frame.julia_param.real = -0.8;
+	frame.julia_param.imag = 0.156;
+
+	util::ThreadPool one(1);
+	util::ThreadPool many(8);
+
+	for (uint which_one = 0; which_one < 4; which_one++)
+	{
+		frame.which_one = which_one;
+		REQUIRE(render_and_wait(one, frame) == render_and_wait(many, frame));
+	}
+}
+
+TEST_CASE("cancelled render stops early", "[render]") {
+	frame_params frame;
+	frame.which_one = 0;
+	frame.width = 640;
+	frame.height = 640;
+	frame.top_left.real = -2;
+	frame.top_left.imag = 2;
+	frame.bottom_right.real = 2;
+	frame.bottom_right.imag = -2;
+	frame.max_iterations = 100000;
+	frame.julia_param.real = 0;
+	frame.julia_param.imag = 0;
+
+	util::ThreadPool pool(2);
+	framebuffer target;
+	target.resize(frame.width, frame.height);
+
+	std::shared_ptr<render_job> job = which(pool, target, frame);
+	target.cancel();
+	REQUIRE(job->cancelled());
+	while (!job->done())
+		std::this_thread::yield();
+
+	finished_tile tile;
+	uint finished = 0;
+	while (target.finished->pop(tile))
+		finished++;
+	REQUIRE(finished < target.tile_count());
+}
+
+// a tile that doesn't fit into the queue isn't lost silently, the ui thread is told to upload the whole frame
+TEST_CASE("full finished queue sets overflowed", "[render]") {
+	frame_params frame;
+	frame.which_one = 0;
+	frame.width = 256;
+	frame.height = 256;
+	frame.top_left = { -2, 2 };
+	frame.bottom_right = { 2, -2 };
+	frame.max_iterations = 100;
+	frame.julia_param = { 0, 0 };
+
+	util::ThreadPool pool(2);
+	framebuffer target;
+	target.resize(frame.width, frame.height);
+	REQUIRE_FALSE(target.overflowed);
+	target.finished = std::make_unique<util::LockFreeQueue<finished_tile>>(2);
+
+	std::shared_ptr<render_job> job = which(pool, target, frame);
+	while (!job->done() || target.busy > 0)
+		std::this_thread::yield();
+	REQUIRE(target.overflowed);
+
+	// resize() makes the queue big enough again
+	target.resize(frame.width + 1, frame.height);
+	REQUIRE_FALSE(target.overflowed);
+}
+
+// the waiting thread is woken by the last task of the frame
+TEST_CASE("waiting for the frame returns once its tiles are done", "[render]") {
+	frame_params frame;
+	frame.which_one = 0;
+	frame.width = 300;
+	frame.height = 200;
+	frame.top_left = { -2, 1.5 };
+	frame.bottom_right = { 1, -1.5 };
+	frame.max_iterations = 500;
+	frame.julia_param = { 0, 0 };
+	frame.progressive = true;
+
+	util::ThreadPool pool(3);
+	framebuffer target;
+	target.resize(frame.width, frame.height);
+	std::shared_ptr<render_job> job = which(pool, target, frame);
+	REQUIRE(target.wait_done(*job, std::chrono::steady_clock::now() + std::chrono::minutes(1)));
+	REQUIRE(job->done());
+	target.wait_idle();
+	REQUIRE(target.busy == 0);
+	REQUIRE(!job->cancelled());
+
+	// nothing queued, it returns right away
+	target.wait_idle();
+
+	// a frame that can't be done in time, the wait ends at the deadline
+	frame.max_iterations = 100000;
+	frame.progressive = false;
+	job = which(pool, target, frame);
+	REQUIRE(!target.wait_done(*job, std::chrono::steady_clock::now()));
+	target.cancel();
+	target.wait_idle();
+}
+
+// a newer frame started while an older one is still running has to end up in the framebuffer unchanged
+TEST_CASE("newer frame wins over a cancelled one", "[render]") {
+	frame_params frame;
+	frame.which_one = 0;
+	frame.width = 256;
+	frame.height = 256;
+	frame.top_left.real = -2;
+	frame.top_left.imag = 2;
+	frame.bottom_right.real = 2;
+	frame.bottom_right.imag = -2;
+	frame.max_iterations = 2000;
+	frame.julia_param.real = 0;
+	frame.julia_param.imag = 0;
+
+	util::ThreadPool pool(4);
+	std::vector<sf::Uint8> expected = render_and_wait(pool, frame);
+
+	framebuffer target;
+	target.resize(frame.width, frame.height);
+
+	frame_params other = frame;
+	other.which_one = 2;
+	std::shared_ptr<render_job> old_job = which(pool, target, other);
+	std::shared_ptr<render_job> new_job = which(pool, target, frame);
+	while (!old_job->done() || !new_job->done())
+		std::this_thread::yield();
+
+	REQUIRE(target.pixels == expected);
+}
+
+// renders the frame tile by tile on this thread with the given method
+static std::vector<sf::Uint8> render_with(const frame_params& frame, row_kernel kernel, render_method method)
+{
+	framebuffer target;
+	target.resize(frame.width, frame.height);
+
+	render_job job;
+	job.frame = frame;
+	job.target = &target;
+	job.generation = target.generation;
+	job.remaining = 0;
+	job.palette = std::make_shared<palette_lut>(build_palette(frame.colours, frame.max_iterations));
+	job.grid = frame_grid(frame);
+	job.method = method;
+
+	for (uint tile = 0; tile < target.tile_count(); tile++)
+		REQUIRE(generate(job, tile, kernel));
+
+	return target.pixels;
+}
+
+// mariani-silver subdivision has to give exactly the same picture as iterating every pixel
+TEST_CASE("subdivision matches brute force on the golden views", "[render]") {
+	const row_kernels& kernels = best_row_kernels();
+
+	frame_params frame;
+	frame.width = 320;
+	frame.height = 240;
+	frame.max_iterations = 1000;
+	frame.julia_param.real = -0.8;
+	frame.julia_param.imag = 0.156;
+
+	// starting view
+	frame.top_left.real = -2;
+	frame.top_left.imag = 1.5;
+	frame.bottom_right.real = 2;
+	frame.bottom_right.imag = -1.5;
+	REQUIRE(render_with(frame, kernels.mandelbrot, render_method::subdivision) == render_with(frame, kernels.mandelbrot, render_method::brute_force));
+	REQUIRE(render_with(frame, kernels.mandelbrot_julia, render_method::subdivision) == render_with(frame, kernels.mandelbrot_julia, render_method::brute_force));
+
+	// elephant valley
+	frame.top_left.real = 0.25;
+	frame.top_left.imag = 0.05;
+	frame.bottom_right.real = 0.35;
+	frame.bottom_right.imag = -0.025;
+	REQUIRE(render_with(frame, kernels.mandelbrot, render_method::subdivision) == render_with(frame, kernels.mandelbrot, render_method::brute_force));
+
+	// the period 3 minibrot on the real axis
+	frame.top_left.real = -1.8;
+	frame.top_left.imag = 0.1;
+	frame.bottom_right.real = -1.7;
+	frame.bottom_right.imag = 0.025;
+	REQUIRE(render_with(frame, kernels.mandelbrot, render_method::subdivision) == render_with(frame, kernels.mandelbrot, render_method::brute_force));
+}
+
+// the progressive passes have to end with the same picture as a single full pass
+TEST_CASE("progressive render ends with the full picture", "[render]") {
+	frame_params frame;
+	frame.width = 203;
+	frame.height = 150;
+	frame.top_left.real = -2;
+	frame.top_left.imag = 1.5;
+	frame.bottom_right.real = 1;
+	frame.bottom_right.imag = -1.5;
+	frame.max_iterations = 255;
+	frame.julia_param.real = -0.12;
+	frame.julia_param.imag = 0.75;
+
+	util::ThreadPool pool(4);
+
+	for (uint which_one = 0; which_one < 4; which_one++)
+	{
+		frame.which_one = which_one;
+		frame.progressive = false;
+		std::vector<sf::Uint8> expected = render_and_wait(pool, frame);
+
+		frame.progressive = true;
+		framebuffer target;
+		target.resize(frame.width, frame.height);
+		std::shared_ptr<render_job> job = which(pool, target, frame);
+		while (!job->done())
+			std::this_thread::yield();
+
+		REQUIRE(target.pixels == expected);
+	}
+}
+
+static std::atomic<uint> counted_pixels { 0 };
+
+static void counting_kernel(const row_job& job, uint* iterations)
+{
+	counted_pixels += job.count;
+	best_row_kernels().burning_ship(job, iterations);
+}
+
+// every pixel is iterated once over all the passes
+TEST_CASE("progressive passes reuse the earlier samples", "[render]") {
+	frame_params frame;
+	frame.which_one = 2;
+	frame.width = 203;
+	frame.height = 150;
+	frame.top_left.real = -2;
+	frame.top_left.imag = 1.5;
+	frame.bottom_right.real = 1;
+	frame.bottom_right.imag = -1.5;
+	frame.max_iterations = 255;
+	frame.julia_param.real = 0;
+	frame.julia_param.imag = 0;
+	frame.progressive = true;
+
+	framebuffer target;
+	target.resize(frame.width, frame.height);
+
+	render_job job;
+	job.frame = frame;
+	job.target = &target;
+	job.generation = target.generation;
+	job.remaining = 0;
+	job.palette = std::make_shared<palette_lut>(build_palette(frame.colours, frame.max_iterations));
+	job.grid = frame_grid(frame);
+
+	counted_pixels = 0;
+	for (uint step = coarsest_step; step >= 1; step /= 2)
+	{
+		for (uint tile = 0; tile < target.tile_count(); tile++)
+			REQUIRE(generate(job, tile, counting_kernel, step));
+	}
+	REQUIRE(counted_pixels == frame.width * frame.height);
+
+	frame.progressive = false;
+	REQUIRE(target.pixels == render_with(frame, best_row_kernels().burning_ship, render_method::brute_force));
+}
+
+// the pixels copied from their mirror images have to be the same as the computed ones
+TEST_CASE("symmetric views give the same picture as computing every pixel", "[render]") {
+	const row_kernels& kernels = best_row_kernels();
+	const row_kernel fractal_kernels[4] = { kernels.mandelbrot, kernels.mandelbrot_julia, kernels.burning_ship, kernels.burning_ship_julia };
+
+	frame_params frame;
+	frame.max_iterations = 255;
+	frame.julia_param.real = -0.12;
+	frame.julia_param.imag = 0.75;
+
+	const double views[3][4] = {
+		{ -2, 2, 2, -2 },		// starting view
+		{ -2, 1.5, 1, -1.5 },	// not centred on 0
+		{ -2, 1.51, 2, -1.49 } // slightly off the axis
+	};
+
+	util::ThreadPool pool(4);
+
+	for (const auto& view : views)
+	{
+		frame.top_left.real = view[0];
+		frame.top_left.imag = view[1];
+		frame.bottom_right.real = view[2];
+		frame.bottom_right.imag = view[3];
+
+		for (uint size : { 256, 203 })
+		{
+			frame.width = size;
+			frame.height = size - 50;
+
+			for (uint which_one = 0; which_one < 4; which_one++)
+			{
+				frame.which_one = which_one;
+				render_method method = which_one < 2 ? render_method::subdivision : render_method::brute_force;
+				if (which_one == 1)
+					method = render_method::brute_force; // this parameter is outside the mandelbrot set
+				REQUIRE(render_and_wait(pool, frame) == render_with(frame, fractal_kernels[which_one], method));
+			}
+		}
+	}
+}
+
+static void wait_for(framebuffer& target, const std::shared_ptr<render_job>& job)
+{
+	while (!job->done())
+		std::this_thread::yield();
+	finished_tile tile;
+	while (target.finished->pop(tile))
+		;
+}
+
+// raising max_iterations continues the pixels of the previous frame, the result has to be the same as starting over
+TEST_CASE("resumed frame matches a fresh render", "[render]") {
+	frame_params frame;
+	frame.width = 203;
+	frame.height = 150;
+	frame.top_left.real = -2;
+	frame.top_left.imag = 1.5;
+	frame.bottom_right.real = 2;
+	frame.bottom_right.imag = -1.5;
+	frame.julia_param.real = -0.8;
+	frame.julia_param.imag = 0.156;
+	frame.progressive = true;
+
+	util::ThreadPool pool(4);
+
+	for (uint which_one = 0; which_one < 4; which_one++)
+	{
+		frame.which_one = which_one;
+
+		framebuffer resumed;
+		resumed.resize(frame.width, frame.height);
+		frame.max_iterations = 1000;
+		wait_for(resumed, which(pool, resumed, frame));
+
+		frame.max_iterations = 4000;
+		std::shared_ptr<render_job> job = which(pool, resumed, frame);
+		REQUIRE(job->resume_from == 1000);
+		wait_for(resumed, job);
+
+		framebuffer fresh;
+		fresh.resize(frame.width, frame.height);
+		wait_for(fresh, which(pool, fresh, frame));
+
+		REQUIRE(resumed.iterations == fresh.iterations);
+		REQUIRE(resumed.pixels == fresh.pixels);
+
+		// lowering it starts over
+		frame.max_iterations = 500;
+		job = which(pool, resumed, frame);
+		REQUIRE(job->resume_from == 0);
+		wait_for(resumed, job);
+	}
+}
+
+// colouring the finished frame again has to give the same pixels as rendering it with the new colours
+TEST_CASE("recolouring matches rendering with the colours", "[render]") {
+	frame_params frame;
+	frame.which_one = 0;
+	frame.width = 203;
+	frame.height = 150;
+	frame.top_left.real = -2;
+	frame.top_left.imag = 1.5;
+	frame.bottom_right.real = 1;
+	frame.bottom_right.imag = -1.5;
+	frame.max_iterations = 255;
+	frame.julia_param.real = 0;
+	frame.julia_param.imag = 0;
+
+	util::ThreadPool pool(4);
+	framebuffer target;
+	target.resize(frame.width, frame.height);
+	wait_for(target, which(pool, target, frame));
+
+	for (uint palette = 0; palette < palette_count; palette++)
+	{
+		frame.colours.palette = palette;
+		frame.colours.smooth = palette != 0;
+		frame.colours.contrast = 1.5;
+		frame.colours.offset = 10;
+
+		recolour(target, frame.colours, frame.max_iterations);
+		REQUIRE(target.pixels == render_and_wait(pool, frame));
+	}
+}
+
+// every pixel is written once at full resolution, the coarse passes add their squares and read back their samples
+TEST_CASE("memory traffic of a frame is counted", "[render]") {
+	frame_params frame;
+	frame.which_one = 2;
+	frame.width = 203;
+	frame.height = 150;
+	frame.top_left.real = -2;
+	frame.top_left.imag = 1.5;
+	frame.bottom_right.real = 1;
+	frame.bottom_right.imag = -1.5;
+	frame.max_iterations = 255;
+	frame.julia_param.real = 0;
+	frame.julia_param.imag = 0;
+
+	const ullong pixel_bytes = 4 + sizeof(uint) + sizeof(complex);
+	util::ThreadPool pool(4);
+	framebuffer target;
+	target.resize(frame.width, frame.height);
+
+	std::shared_ptr<render_job> job = which(pool, target, frame);
+	wait_for(target, job);
+	REQUIRE(job->bytes_written == pixel_bytes * frame.width * frame.height);
+	REQUIRE(job->bytes_read == 0);
+
+	// (in a new framebuffer, the same frame again would take over the pixels of the first one)
+	frame.progressive = true;
+	framebuffer progressive;
+	progressive.resize(frame.width, frame.height);
+	job = which(pool, progressive, frame);
+	wait_for(progressive, job);
+	// every pass draws the whole frame, the full resolution pass reads the samples of the half resolution one
+	REQUIRE(job->bytes_written > pixel_bytes * frame.width * frame.height);
+	REQUIRE(job->bytes_written < 4 * pixel_bytes * frame.width * frame.height);
+	REQUIRE(job->bytes_read == (sizeof(uint) + sizeof(complex)) * ((frame.width + 1) / 2) * ((frame.height + 1) / 2));
+}
+
+// a moved view and a resized window take over the pixels they share with the previous frame,
+// the views are chosen so their own grids are exactly the moved grid and can be compared with a fresh render
+TEST_CASE("moved frame only computes the new strips", "[render]") {
+	frame_params frame;
+	frame.width = 256;
+	frame.height = 192;
+	frame.top_left.real = -2;
+	frame.top_left.imag = 1.5;
+	frame.bottom_right.real = 2;
+	frame.bottom_right.imag = -1.5;
+	frame.max_iterations = 255;
+	frame.julia_param.real = -0.8;
+	frame.julia_param.imag = 0.156;
+
+	const double pixel = 1. / 64;
+	util::ThreadPool pool(4);
+
+	for (uint which_one = 0; which_one < 4; which_one++)
+	{
+		frame.which_one = which_one;
+		frame.width = 256;
+		frame.height = 192;
+		frame.top_left = { -2, 1.5 };
+		frame.bottom_right = { 2, -1.5 };
+
+		framebuffer moved;
+		moved.resize(frame.width, frame.height);
+		wait_for(moved, which(pool, moved, frame));
+
+		// 37 pixels to the right and 20 up
+		frame.top_left.real += 37 * pixel;
+		frame.bottom_right.real += 37 * pixel;
+		frame.top_left.imag += 20 * pixel;
+		frame.bottom_right.imag += 20 * pixel;
+		std::shared_ptr<render_job> job = which(pool, moved, frame);
+		REQUIRE(job->reused.left == 0);
+		REQUIRE(job->reused.top == 20);
+		REQUIRE(job->reused.width == 256 - 37);
+		REQUIRE(job->reused.height == 192 - 20);
+		wait_for(moved, job);
+		REQUIRE(job->pixels_computed > 0);
+		REQUIRE(job->pixels_computed <= frame.width * frame.height - 219 * 172);
+
+		framebuffer fresh;
+		fresh.resize(frame.width, frame.height);
+		wait_for(fresh, which(pool, fresh, frame));
+		REQUIRE(moved.iterations == fresh.iterations);
+		REQUIRE(moved.pixels == fresh.pixels);
+
+		// the window grows by 64 pixels to the right and 32 down
+		frame.width += 64;
+		frame.height += 32;
+		frame.bottom_right.real += 64 * pixel;
+		frame.bottom_right.imag -= 32 * pixel;
+		moved.resize(frame.width, frame.height);
+		job = which(pool, moved, frame);
+		REQUIRE(job->reused.width == 256);
+		REQUIRE(job->reused.height == 192);
+		wait_for(moved, job);
+
+		fresh.resize(frame.width, frame.height);
+		wait_for(fresh, which(pool, fresh, frame));
+		REQUIRE(moved.iterations == fresh.iterations);
+		REQUIRE(moved.pixels == fresh.pixels);
+	}
+}
+
+// zooming 2x in takes over every second pixel in both directions, zooming 2x out takes over a quarter of the frame,
+// the pixel sizes are powers of 2 so the grids line up exactly and the frames can be compared with fresh renders
+TEST_CASE("2x zoom steps only compute the new samples", "[render]") {
+	frame_params frame;
+	frame.width = 256;
+	frame.height = 192;
+	frame.max_iterations = 255;
+	frame.julia_param.real = -0.8;
+	frame.julia_param.imag = 0.156;
+
+	util::ThreadPool pool(4);
+
+	for (uint which_one = 0; which_one < 4; which_one++)
+	{
+		frame.which_one = which_one;
+		frame.top_left = { -2, 1.5 };
+		frame.bottom_right = { 2, -1.5 };
+
+		framebuffer zoomed;
+		zoomed.resize(frame.width, frame.height);
+		wait_for(zoomed, which(pool, zoomed, frame));
+
+		// 2x in around 0.5 + 0.25i
+		frame.top_left = { -0.5, 1 };
+		frame.bottom_right = { 1.5, -0.5 };
+		std::shared_ptr<render_job> job = which(pool, zoomed, frame);
+		REQUIRE(job->reused_spacing == 2);
+		REQUIRE(job->reused.width == 256);
+		REQUIRE(job->reused.height == 192);
+		wait_for(zoomed, job);
+		REQUIRE(job->pixels_computed > 0);
+		REQUIRE(job->pixels_computed <= frame.width * frame.height - 128 * 96);
+
+		framebuffer fresh;
+		fresh.resize(frame.width, frame.height);
+		wait_for(fresh, which(pool, fresh, frame));
+		REQUIRE(zoomed.iterations == fresh.iterations);
+		REQUIRE(zoomed.pixels == fresh.pixels);
+
+		// 2x out around -0.5 + 0.25i
+		frame.top_left = { -2.5, 1.75 };
+		frame.bottom_right = { 1.5, -1.25 };
+		job = which(pool, zoomed, frame);
+		REQUIRE(job->reused_spacing == 1);
+		REQUIRE(job->reused.left == 128);
+		REQUIRE(job->reused.top == 48);
+		REQUIRE(job->reused.width == 128);
+		REQUIRE(job->reused.height == 96);
+		wait_for(zoomed, job);
+		REQUIRE(job->pixels_computed <= frame.width * frame.height - 128 * 96);
+
+		wait_for(fresh, which(pool, fresh, frame));
+		REQUIRE(zoomed.iterations == fresh.iterations);
+		REQUIRE(zoomed.pixels == fresh.pixels);
+	}
+}
+
+// going back to a view rendered before (after another one) takes every pixel from the tile cache
+TEST_CASE("revisited view comes from the tile cache", "[render]") {
+	frame_params frame;
+	frame.width = 203;
+	frame.height = 150;
+	frame.max_iterations = 255;
+	frame.julia_param.real = -0.8;
+	frame.julia_param.imag = 0.156;
+	frame.progressive = true;
+
+	util::ThreadPool pool(4);
+
+	for (uint which_one = 0; which_one < 4; which_one++)
+	{
+		frame.which_one = which_one;
+		frame.top_left = { -2, 1.5 };
+		frame.bottom_right = { 1, -1.5 };
+
+		tile_cache cache;
+		framebuffer target;
+		target.cache = &cache;
+		target.resize(frame.width, frame.height);
+		wait_for(target, which(pool, target, frame));
+		std::vector<uint> first = target.iterations;
+		std::vector<sf::Uint8> pixels = target.pixels;
+
+		frame_params other = frame;
+		other.top_left = { -0.5, 0.5 };
+		other.bottom_right = { 0.5, -0.5 };
+		wait_for(target, which(pool, target, other));
+
+		std::shared_ptr<render_job> job = which(pool, target, frame);
+		REQUIRE(!job->frame.progressive);
+		wait_for(target, job);
+		REQUIRE(job->pixels_computed == 0);
+		REQUIRE(target.iterations == first);
+		REQUIRE(target.pixels == pixels);
+	}
+}
+
+// the next run of the program (a new cache on the same directory) doesn't compute a deep zoom view again
+TEST_CASE("deep view comes back from the disk cache", "[render]") {
+	util::fs::path directory = util::fs::temp_directory_path() / "fractal_render_cache_test";
+	util::fs::remove_all(directory);
+
+	frame_params frame;
+	frame.which_one = 0;
+	frame.width = 150;
+	frame.height = 100;
+	frame.max_iterations = 1000;
+	frame.deep = true;
+	frame.view.center_real = big_from_double(-0.743643887037151, 2);
+	frame.view.center_imag = big_from_double(0.131825904205330, 2);
+	frame.view.pixel = { 1e-15, 1e-15 };
+
+	util::ThreadPool pool(4);
+	std::vector<uint> first;
+	{
+		tile_cache cache;
+		cache.set_directory(directory.string());
+		framebuffer target;
+		target.cache = &cache;
+		target.resize(frame.width, frame.height);
+		std::shared_ptr<render_job> job = which(pool, target, frame);
+		wait_for(target, job);
+		REQUIRE(job->pixels_computed > 0);
+		first = target.iterations;
+	}
+
+	tile_cache cache;
+	cache.set_directory(directory.string());
+	framebuffer target;
+	target.cache = &cache;
+	target.resize(frame.width, frame.height);
+	std::shared_ptr<render_job> job = which(pool, target, frame);
+	wait_for(target, job);
+	REQUIRE(job->pixels_computed == 0);
+	REQUIRE(cache.disk_hits > 0);
+	REQUIRE(target.iterations == first);
+
+	// a different centre is a different grid
+	move_view(frame.view, 1, 0);
+	job = which(pool, target, frame);
+	wait_for(target, job);
+	REQUIRE(job->pixels_computed > 0);
+
+	util::fs::remove_all(directory);
+}
@@ -0,0 +1,79 @@
+#include <catch2/catch.hpp>
+
+#include "Fractal/Kernels.hpp"
+#include "Fractal/Telemetry.hpp"
+
+// the counters are added up from the iterations of the framebuffer, they have to match iterating every pixel
+TEST_CASE("frame stats count the iterations of the finished frame", "[telemetry]") {
+	frame_params frame;
+	frame.which_one = 0;
+	frame.width = 130;
+	frame.height = 90;
+	frame.top_left = { -2, 1.2 };
+	frame.bottom_right = { 1, -1.2 };
+	frame.max_iterations = 200;
+	frame.julia_param = { 0, 0 };
+
+	util::ThreadPool pool(2);
+	framebuffer target;
+	target.resize(frame.width, frame.height);
+	std::shared_ptr<render_job> job = which(pool, target, frame);
+	while (!job->done() || target.busy > 0)
+		std::this_thread::yield();
+
+	frame_stats stats;
+	stats.number = 7;
+	finish_stats(stats, *job);
+	// timed by the last tile of the job
+	REQUIRE(stats.render_seconds > 0);
+	REQUIRE(stats.render_seconds == job->render_seconds);
+	stats.render_seconds = 0.5;
+
+	const pixel_grid grid = frame_grid(frame);
+	ullong iterations = 0;
+	ullong at_max = 0;
+	for (uint y = 0; y < frame.height; y++)
+	{
+		for (uint x = 0; x < frame.width; x++)
+		{
+			complex pos = { grid.center.real + (x + grid.x_offset) * grid.delta.real, grid.center.imag - (y + grid.y_offset) * grid.delta.imag };
+			uint count = mendel_iter(pos, frame.max_iterations);
+			iterations += count;
+			at_max += count == frame.max_iterations;
+		}
+	}
+	REQUIRE(stats.iterations == iterations);
+	REQUIRE(stats.at_max == at_max);
+	REQUIRE(stats.at_max > 0);
+	REQUIRE(stats.at_max_fraction() == Approx((double)at_max / (130 * 90)));
+	REQUIRE(stats.megapixels_per_second() == Approx(130 * 90 / 0.5 / 1e6));
+	REQUIRE(stats.pixels_computed <= 130 * 90);
+	REQUIRE(stats.bytes_written == job->bytes_written);
+	REQUIRE(stats.bytes_written > 0);
+	REQUIRE(stats.bytes_per_pixel() == Approx((double)(stats.bytes_read + stats.bytes_written) / (130 * 90)));
+	REQUIRE(stats.cache_tiles == 0);
+	REQUIRE(stats_text(stats, true, 0.002).find("Frame 7 (rendering") == 0);
+
+	// a line of the csv file for every frame, with as many columns as the header
+	const std::string path = "test_telemetry.csv";
+	{
+		telemetry_log log;
+		REQUIRE(log.open(path));
+		log.write(stats);
+		log.write(stats);
+	}
+	std::ifstream file(path);
+	std::string header, line;
+	REQUIRE(std::getline(file, header));
+	REQUIRE(header.find("frame,fractal,width,height") == 0);
+	uint lines = 0;
+	while (std::getline(file, line))
+	{
+		REQUIRE(std::count(line.begin(), line.end(), ',') == std::count(header.begin(), header.end(), ','));
+		REQUIRE(line.find("7,0,130,90,200,0,500,") == 0);
+		lines++;
+	}
+	REQUIRE(lines == 2);
+	file.close();
+	std::remove(path.c_str());
+}
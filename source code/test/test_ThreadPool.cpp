@@ -0,0 +1,33 @@
+#include <catch2/catch.hpp>
+
+#include "Utility/ThreadPool.hpp"
+
+TEST_CASE("util::ThreadPool::parallelFor", "[threadpool]") {
+	for (uint threads : { 1u, 2u, 3u, 8u })
+	{
+		util::ThreadPool pool(threads);
+		REQUIRE(pool.getThreadCount() == threads);
+
+		// every index has to be visited exactly once
+		std::vector<std::atomic<uint>> visits(1000);
+		pool.parallelFor(1000, [&](uint i) {
+			visits[i]++;
+		});
+
+		for (std::atomic<uint>& count : visits)
+			REQUIRE(count == 1);
+	}
+}
+
+TEST_CASE("util::ThreadPool::submit", "[threadpool]") {
+	std::atomic<uint> done { 0 };
+	{
+		util::ThreadPool pool(4);
+		for (uint i = 0; i < 100; i++)
+			pool.submit([&]() {
+				done++;
+			});
+	} // the destructor finishes the queued tasks
+
+	REQUIRE(done == 100);
+}
@@ -0,0 +1,217 @@
+#include <catch2/catch.hpp>
+
+#include "Fractal/TileCache.hpp"
+
+static cache_key test_key(double delta)
+{
+	cache_key key {};
+	key.max_iterations = 255;
+	key.delta = { delta, delta };
+	return key;
+}
+
+// a rectangle that isn't aligned to the tiles (and goes below 0) has to come back as it was stored
+TEST_CASE("cached pixels come back where they were stored", "[tile_cache]") {
+	tile_cache cache;
+	const uint width = 100;
+	const uint height = 70;
+	std::vector<uint> iterations(width * height);
+	std::vector<complex> last_z(width * height);
+	for (uint i = 0; i < width * height; i++)
+	{
+		iterations[i] = i;
+		last_z[i] = { (double)i, -(double)i };
+	}
+	cache.store(test_key(0.5), -30, 17, width, height, iterations.data(), last_z.data(), width);
+	REQUIRE(cache.covers(test_key(0.5), -30, 17, width, height));
+	REQUIRE(!cache.covers(test_key(0.5), -31, 17, width, height));
+	REQUIRE(!cache.covers(test_key(0.25), -30, 17, width, height));
+
+	// a part of it, into rows of a different length
+	const uint stride = 64;
+	std::vector<uint> found(stride * 40, 0);
+	std::vector<complex> found_z(stride * 40);
+	bool known[stride * 40] = {};
+	REQUIRE(cache.lookup(test_key(0.5), -20, 30, 50, 40, found.data(), found_z.data(), known, stride) == 50 * 40);
+	for (uint y = 0; y < 40; y++)
+	{
+		for (uint x = 0; x < 50; x++)
+		{
+			uint i = (y + 13) * width + x + 10;
+			REQUIRE(known[y * stride + x]);
+			REQUIRE(found[y * stride + x] == i);
+			REQUIRE(found_z[y * stride + x].imag == -(double)i);
+		}
+	}
+
+	// the pixels that are known already are left alone, a different zoom level has nothing
+	REQUIRE(cache.lookup(test_key(0.5), -20, 30, 50, 40, found.data(), found_z.data(), known, stride) == 0);
+	bool nothing[stride * 40] = {};
+	REQUIRE(cache.lookup(test_key(0.25), -20, 30, 50, 40, found.data(), found_z.data(), nothing, stride) == 0);
+}
+
+// over the budget the tiles used the longest time ago are dropped first
+TEST_CASE("least recently used tiles are evicted", "[tile_cache]") {
+	std::vector<uint> iterations(cache_tile_size * cache_tile_size, 7);
+	std::vector<complex> last_z(cache_tile_size * cache_tile_size);
+
+	tile_cache cache;
+	cache.store(test_key(1), 0, 0, cache_tile_size, cache_tile_size, iterations.data(), last_z.data(), cache_tile_size);
+	size_t tile_bytes = cache.size();
+	cache.set_budget(3 * tile_bytes);
+
+	for (uint level = 2; level <= 3; level++)
+		cache.store(test_key(level), 0, 0, cache_tile_size, cache_tile_size, iterations.data(), last_z.data(), cache_tile_size);
+	REQUIRE(cache.tile_count() == 3);
+
+	// using the first tile makes the second the oldest one
+	REQUIRE(cache.covers(test_key(1), 0, 0, 1, 1));
+	uint found;
+	complex found_z;
+	bool known = false;
+	REQUIRE(cache.lookup(test_key(1), 0, 0, 1, 1, &found, &found_z, &known, 1) == 1);
+
+	cache.store(test_key(4), 0, 0, cache_tile_size, cache_tile_size, iterations.data(), last_z.data(), cache_tile_size);
+	REQUIRE(cache.tile_count() == 3);
+	REQUIRE(cache.size() <= cache.budget());
+	REQUIRE(cache.covers(test_key(1), 0, 0, cache_tile_size, cache_tile_size));
+	REQUIRE(!cache.covers(test_key(2), 0, 0, 1, 1));
+	REQUIRE(cache.covers(test_key(3), 0, 0, cache_tile_size, cache_tile_size));
+	REQUIRE(cache.covers(test_key(4), 0, 0, cache_tile_size, cache_tile_size));
+
+	cache.set_budget(tile_bytes);
+	REQUIRE(cache.tile_count() == 1);
+	REQUIRE(cache.covers(test_key(4), 0, 0, 1, 1));
+}
+
+// the tiles of the grids that can't come back make room for the other ones first and never get to the disk
+TEST_CASE("transient tiles are evicted first and not written", "[tile_cache]") {
+	util::fs::path directory = util::fs::temp_directory_path() / "fractal_tile_cache_transient_test";
+	std::error_code error;
+	util::fs::remove_all(directory, error);
+
+	std::vector<uint> iterations(cache_tile_size * cache_tile_size, 7);
+	std::vector<complex> last_z(cache_tile_size * cache_tile_size);
+	{
+		tile_cache cache;
+		cache.set_directory(directory.string());
+		cache.store(test_key(1), 0, 0, cache_tile_size, cache_tile_size, iterations.data(), last_z.data(), cache_tile_size);
+		cache.set_budget(3 * cache.size());
+		cache.store(test_key(2), 0, 0, cache_tile_size, cache_tile_size, iterations.data(), last_z.data(), cache_tile_size, true);
+		cache.store(test_key(3), 0, 0, cache_tile_size, cache_tile_size, iterations.data(), last_z.data(), cache_tile_size, true);
+		REQUIRE(cache.tile_count() == 3);
+
+		// the oldest tile is a recurring one, the transient ones go first anyway
+		cache.store(test_key(4), 0, 0, cache_tile_size, cache_tile_size, iterations.data(), last_z.data(), cache_tile_size);
+		REQUIRE(cache.tile_count() == 3);
+		REQUIRE(cache.covers(test_key(1), 0, 0, 1, 1));
+		REQUIRE(!cache.covers(test_key(2), 0, 0, 1, 1));
+		REQUIRE(cache.covers(test_key(3), 0, 0, 1, 1));
+		REQUIRE(cache.covers(test_key(4), 0, 0, 1, 1));
+
+		// storing the grid as recurring keeps the tile for good
+		cache.store(test_key(3), 0, 0, 1, 1, iterations.data(), last_z.data(), cache_tile_size);
+		cache.store(test_key(5), 0, 0, cache_tile_size, cache_tile_size, iterations.data(), last_z.data(), cache_tile_size, true);
+		cache.store(test_key(6), 0, 0, cache_tile_size, cache_tile_size, iterations.data(), last_z.data(), cache_tile_size, true);
+		REQUIRE(cache.covers(test_key(3), 0, 0, 1, 1));
+	}
+
+	tile_cache cache;
+	cache.set_directory(directory.string());
+	REQUIRE(cache.covers(test_key(1), 0, 0, 1, 1));
+	REQUIRE(cache.covers(test_key(3), 0, 0, 1, 1));
+	REQUIRE(cache.covers(test_key(4), 0, 0, 1, 1));
+	REQUIRE(!cache.covers(test_key(5), 0, 0, 1, 1));
+	REQUIRE(!cache.covers(test_key(6), 0, 0, 1, 1));
+	util::fs::remove_all(directory, error);
+}
+
+// a new cache with the same directory (the next run of the program) finds the tiles on the disk
+TEST_CASE("tiles are kept on the disk", "[tile_cache]") {
+	util::fs::path directory = util::fs::temp_directory_path() / "fractal_tile_cache_test";
+	util::fs::remove_all(directory);
+
+	const uint width = 90;
+	const uint height = 40;
+	std::vector<uint> iterations(width * height);
+	std::vector<complex> last_z(width * height);
+	for (uint i = 0; i < width * height; i++)
+	{
+		iterations[i] = 3 * i;
+		last_z[i] = { 0.5 * i, 1 };
+	}
+
+	{
+		tile_cache cache;
+		cache.set_directory(directory.string());
+		cache.store(test_key(0.5), 10, -5, width, height, iterations.data(), last_z.data(), width);
+	}
+
+	tile_cache cache;
+	cache.set_directory(directory.string());
+	REQUIRE(cache.tile_count() == 0);
+	REQUIRE(cache.covers(test_key(0.5), 10, -5, width, height));
+	REQUIRE(!cache.covers(test_key(0.5), 10, -6, width, height));
+
+	std::vector<uint> found(width * height);
+	std::vector<complex> found_z(width * height);
+	std::unique_ptr<bool[]> known = std::make_unique<bool[]>(width * height);
+	REQUIRE(cache.lookup(test_key(0.5), 10, -5, width, height, found.data(), found_z.data(), known.get(), width) == width * height);
+	REQUIRE(cache.disk_hits > 0);
+	REQUIRE(found == iterations);
+	for (uint i = 0; i < width * height; i++)
+		REQUIRE(found_z[i].real == last_z[i].real);
+
+	// storing more of a tile that is on the disk keeps the pixels that were there
+	cache.store(test_key(0.5), 100, -5, 10, height, iterations.data(), last_z.data(), width);
+	cache.flush();
+	cache.clear();
+	REQUIRE(cache.covers(test_key(0.5), 10, -5, width + 10, height));
+
+	util::fs::remove_all(directory);
+}
+
+// the directory doesn't grow past its budget, the files used least recently are deleted, also by the next runs
+TEST_CASE("tile files are kept within the disk budget", "[tile_cache]") {
+	util::fs::path directory = util::fs::temp_directory_path() / "fractal_tile_cache_budget_test";
+	std::error_code error;
+	util::fs::remove_all(directory, error);
+
+	std::vector<uint> iterations(cache_tile_size * cache_tile_size, 7);
+	std::vector<complex> last_z(cache_tile_size * cache_tile_size);
+	size_t file_bytes;
+	{
+		tile_cache cache;
+		cache.set_directory(directory.string());
+		for (uint level = 1; level <= 3; level++)
+			cache.store(test_key(level), 0, 0, cache_tile_size, cache_tile_size, iterations.data(), last_z.data(), cache_tile_size);
+		REQUIRE(cache.disk_size() == 0);
+		cache.flush();
+		file_bytes = cache.disk_size() / 3;
+		REQUIRE(file_bytes > 0);
+
+		cache.set_disk_budget(2 * file_bytes);
+		REQUIRE(cache.disk_size() == 2 * file_bytes);
+		cache.clear();
+		REQUIRE(!cache.covers(test_key(1), 0, 0, 1, 1));
+		REQUIRE(cache.covers(test_key(2), 0, 0, 1, 1));
+		REQUIRE(cache.covers(test_key(3), 0, 0, 1, 1));
+	}
+
+	// reading a file makes it the most recently used one, also for the next runs
+	{
+		tile_cache cache(256 << 20, 2 * file_bytes);
+		cache.set_directory(directory.string());
+		REQUIRE(cache.disk_size() == 2 * file_bytes);
+		uint found;
+		complex found_z;
+		bool known = false;
+		REQUIRE(cache.lookup(test_key(2), 0, 0, 1, 1, &found, &found_z, &known, 1) == 1);
+	}
+	tile_cache cache(256 << 20, file_bytes);
+	cache.set_directory(directory.string());
+	REQUIRE(cache.disk_size() == file_bytes);
+	REQUIRE(cache.covers(test_key(2), 0, 0, 1, 1));
+	REQUIRE(!cache.covers(test_key(3), 0, 0, 1, 1));
+	util::fs::remove_all(directory, error);
+}